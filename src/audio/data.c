@@ -583,7 +583,7 @@ f32 gVolRampingRhs128[128] = {
 
 s16 gTatumsPerBeat = TATUMS_PER_BEAT;
 s8 gUnusedCount80333EE8 = UNUSED_COUNT_80333EE8;
-s32 gAudioHeapSize = DOUBLE_SIZE_ON_64_BIT(AUDIO_HEAP_SIZE);
+s32 gAudioHeapSize = DOUBLE_SIZE_ON_64_BIT(AUDIO_HEAP_SIZE) + AUDIO_NOTES_HEAP_RESERVE;
 s32 D_80333EF0 = DOUBLE_SIZE_ON_64_BIT(D_80333EF0_VAL);
 volatile s32 gAudioLoadLock = AUDIO_LOCK_UNINITIALIZED;
 
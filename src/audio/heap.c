@@ -760,6 +760,9 @@ void audio_reset_session(void) {
     gAudioBufferParameters.updatesPerFrameInv = 1.0f / gAudioBufferParameters.updatesPerFrame;
 
     gMaxSimultaneousNotes = preset->maxSimultaneousNotes;
+#ifdef AUDIO_DYNAMIC_NOTES
+    gMaxSimultaneousNotes = note_pool_capacity(gMaxSimultaneousNotes);
+#endif
     gVolume = preset->volume;
     gTempoInternalToExternal = (u32) (gAudioBufferParameters.updatesPerFrame * 2880000.0f / gTatumsPerBeat / D_EU_802298D0);
 
@@ -774,6 +777,9 @@ void audio_reset_session(void) {
     reverbWindowSize = preset->reverbWindowSize;
     gAiFrequency = osAiSetFrequency(preset->frequency);
     gMaxSimultaneousNotes = preset->maxSimultaneousNotes;
+#ifdef AUDIO_DYNAMIC_NOTES
+    gMaxSimultaneousNotes = note_pool_capacity(gMaxSimultaneousNotes);
+#endif
     gSamplesPerFrameTarget = ALIGN16(gAiFrequency / 60);
     gReverbDownsampleRate = preset->reverbDownsampleRate;
 
@@ -798,6 +804,13 @@ void audio_reset_session(void) {
     }
 
     gReverbDownsampleRate = preset->reverbDownsampleRate;
+#ifndef TARGET_N64
+    if (gAudioReverbFullRate) {
+        // Keep the same delay, but skip the downsample/upsample round trip
+        reverbWindowSize *= gReverbDownsampleRate;
+        gReverbDownsampleRate = 1;
+    }
+#endif
     gVolume = preset->volume;
     gMinAiBufferLength = gSamplesPerFrameTarget - 0x10;
     updatesPerFrame = gSamplesPerFrameTarget / 160 + 1;
@@ -847,7 +860,11 @@ void audio_reset_session(void) {
 
     gNotes = soundAlloc(&gNotesAndBuffersPool, gMaxSimultaneousNotes * sizeof(struct Note));
     note_init_all();
+#ifdef AUDIO_DYNAMIC_NOTES
+    init_note_free_list_with_reserve(preset->maxSimultaneousNotes);
+#else
     init_note_free_list();
+#endif
 
 #ifdef VERSION_EU
     gNoteSubsEu = soundAlloc(&gNotesAndBuffersPool, (gAudioBufferParameters.updatesPerFrame * gMaxSimultaneousNotes) * sizeof(struct NoteSubEu));
@@ -865,6 +882,13 @@ void audio_reset_session(void) {
         reverbSettings = &preset->reverbSettings[j];
         reverb->windowSize = reverbSettings->windowSize * 64;
         reverb->downsampleRate = reverbSettings->downsampleRate;
+#ifndef TARGET_N64
+        if (gAudioReverbFullRate) {
+            // Keep the same delay, but skip the downsample/upsample round trip
+            reverb->windowSize *= reverb->downsampleRate;
+            reverb->downsampleRate = 1;
+        }
+#endif
         reverb->reverbGain = reverbSettings->gain;
         reverb->useReverb = 8;
         reverb->ringBuffer.left = soundAlloc(&gNotesAndBuffersPool, reverb->windowSize * 2);
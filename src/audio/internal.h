@@ -22,6 +22,17 @@
 #define LAYERS_MAX       4
 #define CHANNELS_MAX     16
 
+// Desktop builds can grow the note pool past the session preset's maxSimultaneousNotes,
+// up to gAudioMaxNotes (at most AUDIO_MAX_NOTES_LIMIT), instead of stealing voices.
+// The audio heap gets extra room for the notes, their synthesis buffers and sample DMAs.
+#if !defined(TARGET_N64) && !defined(TARGET_N3DS)
+#define AUDIO_DYNAMIC_NOTES
+#define AUDIO_MAX_NOTES_LIMIT 64
+#define AUDIO_NOTES_HEAP_RESERVE (AUDIO_MAX_NOTES_LIMIT * 0x2000)
+#else
+#define AUDIO_NOTES_HEAP_RESERVE 0
+#endif
+
 #define NO_LAYER ((struct SequenceChannelLayer *)(-1))
 
 #define MUTE_BEHAVIOR_STOP_SCRIPT 0x80 // stop processing sequence/channel scripts
@@ -43,7 +43,11 @@ OSMesgQueue gAudioDmaMesgQueue;
 OSMesg gAudioDmaMesg;
 OSIoMesg gAudioDmaIoMesg;
 
+#ifdef AUDIO_DYNAMIC_NOTES
+struct SharedDma sSampleDmas[AUDIO_MAX_NOTES_LIMIT * 4];
+#else
 struct SharedDma sSampleDmas[0x60];
+#endif
 u32 gSampleDmaNumListItems;
 u32 sSampleDmaListSize1;
 u32 sUnused80226B40; // set to 0, never read
@@ -76,6 +80,12 @@ s32 gAiFrequency;
 u32 D_80226D68;
 s32 gMaxAudioCmds;
 s32 gMaxSimultaneousNotes;
+#ifdef AUDIO_DYNAMIC_NOTES
+s32 gAudioMaxNotes;
+#endif
+#ifndef TARGET_N64
+s8 gAudioReverbFullRate;
+#endif
 
 #ifdef VERSION_EU
 s16 gTempoInternalToExternal;
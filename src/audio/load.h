@@ -42,6 +42,12 @@ extern u32 D_80226D68;
 extern s32 gMaxAudioCmds;
 
 extern s32 gMaxSimultaneousNotes;
+#ifdef AUDIO_DYNAMIC_NOTES
+extern s32 gAudioMaxNotes; // Note pool growth limit, 0 to keep the preset's count
+#endif
+#ifndef TARGET_N64
+extern s8 gAudioReverbFullRate; // Run downsampled reverbs at the full rate on the next session reset
+#endif
 extern s32 gSamplesPerFrameTarget;
 extern s32 gMinAiBufferLength;
 extern s16 gTempoInternalToExternal;
@@ -9,6 +9,13 @@
 #include "effects.h"
 #include "external.h"
 
+#ifdef AUDIO_DYNAMIC_NOTES
+struct NotePoolStats gNotePoolStats;
+
+// Index of the first note that hasn't been handed out to the free lists this session
+static s32 sNoteReserveNext;
+#endif
+
 #ifdef VERSION_EU
 void note_set_vel_pan_reverb(struct Note *note, f32 velocity, u8 pan, u8 reverb) {
     struct NoteSubEu *sub = &note->noteSubEu;
@@ -410,6 +417,9 @@ void process_notes(void) {
     }
 #undef PREPEND
 #undef POP
+#ifdef AUDIO_DYNAMIC_NOTES
+    note_pool_update_stats();
+#endif
 }
 
 void seq_channel_layer_decay_release_internal(struct SequenceChannelLayer *seqLayer, s32 target) {
@@ -638,6 +648,52 @@ void init_note_free_list(void) {
     }
 }
 
+#ifdef AUDIO_DYNAMIC_NOTES
+s32 note_pool_capacity(s32 presetNotes) {
+    s32 limit = gAudioMaxNotes > AUDIO_MAX_NOTES_LIMIT ? AUDIO_MAX_NOTES_LIMIT : gAudioMaxNotes;
+
+    return limit > presetNotes ? limit : presetNotes;
+}
+
+// Like init_note_free_list, but only the first initialNotes notes go to the free lists.
+// The rest are handed out one at a time by alloc_note_from_reserve.
+void init_note_free_list_with_reserve(s32 initialNotes) {
+    s32 i;
+
+    init_note_lists(&gNoteFreeLists);
+    for (i = 0; i < gMaxSimultaneousNotes; i++) {
+        gNotes[i].listItem.u.value = &gNotes[i];
+        gNotes[i].listItem.prev = NULL;
+        if (i < initialNotes) {
+            audio_list_push_back(&gNoteFreeLists.disabled, &gNotes[i].listItem);
+        }
+    }
+    sNoteReserveNext = initialNotes;
+    gNotePoolStats.capacity = gMaxSimultaneousNotes;
+    gNotePoolStats.inUse = initialNotes;
+}
+
+void note_pool_update_stats(void) {
+    u32 voices = 0;
+    s32 i;
+
+    for (i = 0; i < sNoteReserveNext; i++) {
+#ifdef VERSION_EU
+        if (gNotes[i].noteSubEu.enabled) {
+#else
+        if (gNotes[i].enabled) {
+#endif
+            voices++;
+        }
+    }
+    gNotePoolStats.activeVoices = voices;
+    if (voices > gNotePoolStats.peakVoices) {
+        gNotePoolStats.peakVoices = voices;
+    }
+    gNotePoolStats.voiceUpdates += voices;
+}
+#endif
+
 void note_pool_clear(struct NotePool *pool) {
     s32 i;
     struct AudioListItem *source;
@@ -888,6 +944,9 @@ struct Note *alloc_note_from_decaying(struct NotePool *pool, struct SequenceChan
     if (note != NULL) {
         note_release_and_take_ownership(note, seqLayer);
         audio_list_push_back(&pool->releasing, &note->listItem);
+#ifdef AUDIO_DYNAMIC_NOTES
+        gNotePoolStats.stolenDecaying++;
+#endif
     }
     return note;
 }
@@ -898,10 +957,26 @@ struct Note *alloc_note_from_active(struct NotePool *pool, struct SequenceChanne
     if (note != NULL) {
         func_80319728(note, seqLayer);
         audio_list_push_back(&pool->releasing, &note->listItem);
+#ifdef AUDIO_DYNAMIC_NOTES
+        gNotePoolStats.stolenActive++;
+#endif
     }
     return note;
 }
 
+#ifdef AUDIO_DYNAMIC_NOTES
+// Grows the note pool by one note and allocates it from 'pool', so that a layer which would
+// otherwise steal a voice gets a fresh one. Fails once the session's capacity is reached.
+struct Note *alloc_note_from_reserve(struct NotePool *pool, struct SequenceChannelLayer *seqLayer) {
+    if (sNoteReserveNext >= gMaxSimultaneousNotes) {
+        return NULL;
+    }
+    audio_list_push_back(&pool->disabled, &gNotes[sNoteReserveNext++].listItem);
+    gNotePoolStats.inUse = sNoteReserveNext;
+    return alloc_note_from_disabled(pool, seqLayer);
+}
+#endif
+
 struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
     struct Note *ret;
     u32 policy = seqLayer->seqChannel->noteAllocPolicy;
@@ -926,9 +1001,15 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
 
     if (policy & NOTE_ALLOC_CHANNEL) {
         if (!(ret = alloc_note_from_disabled(&seqLayer->seqChannel->notePool, seqLayer))
+#ifdef AUDIO_DYNAMIC_NOTES
+            && !(ret = alloc_note_from_reserve(&seqLayer->seqChannel->notePool, seqLayer))
+#endif
             && !(ret = alloc_note_from_decaying(&seqLayer->seqChannel->notePool, seqLayer))
             && !(ret = alloc_note_from_active(&seqLayer->seqChannel->notePool, seqLayer))) {
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
+#ifdef AUDIO_DYNAMIC_NOTES
+            gNotePoolStats.dropped++;
+#endif
             return NULL;
         }
         return ret;
@@ -937,11 +1018,17 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
     if (policy & NOTE_ALLOC_SEQ) {
         if (!(ret = alloc_note_from_disabled(&seqLayer->seqChannel->notePool, seqLayer))
             && !(ret = alloc_note_from_disabled(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
+#ifdef AUDIO_DYNAMIC_NOTES
+            && !(ret = alloc_note_from_reserve(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
+#endif
             && !(ret = alloc_note_from_decaying(&seqLayer->seqChannel->notePool, seqLayer))
             && !(ret = alloc_note_from_decaying(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
             && !(ret = alloc_note_from_active(&seqLayer->seqChannel->notePool, seqLayer))
             && !(ret = alloc_note_from_active(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))) {
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
+#ifdef AUDIO_DYNAMIC_NOTES
+            gNotePoolStats.dropped++;
+#endif
             return NULL;
         }
         return ret;
@@ -949,9 +1036,15 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
 
     if (policy & NOTE_ALLOC_GLOBAL_FREELIST) {
         if (!(ret = alloc_note_from_disabled(&gNoteFreeLists, seqLayer))
+#ifdef AUDIO_DYNAMIC_NOTES
+            && !(ret = alloc_note_from_reserve(&gNoteFreeLists, seqLayer))
+#endif
             && !(ret = alloc_note_from_decaying(&gNoteFreeLists, seqLayer))
             && !(ret = alloc_note_from_active(&gNoteFreeLists, seqLayer))) {
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
+#ifdef AUDIO_DYNAMIC_NOTES
+            gNotePoolStats.dropped++;
+#endif
             return NULL;
         }
         return ret;
@@ -960,6 +1053,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
     if (!(ret = alloc_note_from_disabled(&seqLayer->seqChannel->notePool, seqLayer))
         && !(ret = alloc_note_from_disabled(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
         && !(ret = alloc_note_from_disabled(&gNoteFreeLists, seqLayer))
+#ifdef AUDIO_DYNAMIC_NOTES
+        && !(ret = alloc_note_from_reserve(&gNoteFreeLists, seqLayer))
+#endif
         && !(ret = alloc_note_from_decaying(&seqLayer->seqChannel->notePool, seqLayer))
         && !(ret = alloc_note_from_decaying(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
         && !(ret = alloc_note_from_decaying(&gNoteFreeLists, seqLayer))
@@ -967,6 +1063,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
         && !(ret = alloc_note_from_active(&seqLayer->seqChannel->seqPlayer->notePool, seqLayer))
         && !(ret = alloc_note_from_active(&gNoteFreeLists, seqLayer))) {
         seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
+#ifdef AUDIO_DYNAMIC_NOTES
+        gNotePoolStats.dropped++;
+#endif
         return NULL;
     }
     return ret;
@@ -30,6 +30,26 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer);
 void reclaim_notes(void);
 void note_init_all(void);
 
+#ifdef AUDIO_DYNAMIC_NOTES
+struct NotePoolStats {
+    s32 capacity;       // Notes allocated this session (the preset's count or gAudioMaxNotes)
+    s32 inUse;          // Notes handed out to the free lists so far; grows on demand
+    u32 stolenDecaying; // Allocations that took over a note that was fading out
+    u32 stolenActive;   // Allocations that cut off a playing note of lower priority
+    u32 dropped;        // Layers that didn't get a note at all
+    u32 activeVoices;   // Enabled notes after the last process_notes()
+    u32 peakVoices;
+    u64 voiceUpdates;   // Sum of activeVoices over all updates, to derive synthesis cost per voice
+};
+
+extern struct NotePoolStats gNotePoolStats;
+
+s32 note_pool_capacity(s32 presetNotes);
+void init_note_free_list_with_reserve(s32 initialNotes);
+struct Note *alloc_note_from_reserve(struct NotePool *pool, struct SequenceChannelLayer *seqLayer);
+void note_pool_update_stats(void);
+#endif
+
 #ifdef VERSION_EU
 struct AudioBankSound *instrument_get_audio_bank_sound(struct Instrument *instrument, s32 semitone);
 struct Instrument *get_instrument_inner(s32 bankId, s32 instId);
@@ -6,6 +6,7 @@
 #include "heap.h"
 #include "load.h"
 #include "seqplayer.h"
+#include "../pc/audio/audio_profiler.h"
 
 #define PORTAMENTO_IS_SPECIAL(x) ((x).mode & 0x80)
 #define PORTAMENTO_MODE(x) ((x).mode & ~0x80)
@@ -2002,7 +2003,7 @@ void process_sequences(UNUSED s32 iterationsRemaining) {
 #ifndef VERSION_EU
     reclaim_notes();
 #endif
-    process_notes();
+    AUDIO_PROFILER_WRAP(AUDIO_PROFILER_PROCESS_NOTES, process_notes());
 }
 
 void init_sequence_player(u32 player) {
@@ -8,8 +8,16 @@
 #include "external.h"
 
 #ifndef TARGET_N64
+#include <stdbool.h>
 #include "../pc/mixer.h"
 #endif
+#include "../pc/audio/audio_profiler.h"
+
+#if !defined(TARGET_N64) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif !defined(TARGET_N64) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #ifdef TARGET_N3DS
 #include "src/pc/audio/audio_3ds.h"
@@ -92,6 +100,55 @@ struct SynthesisReverb gSynthesisReverb;
 u8 sAudioSynthesisPad[0x20];
 #endif
 
+#ifndef TARGET_N64
+// Downsamples reverb by keeping every rate'th sample, like the loops in the N64 code.
+// The presets only use rates 1, 2 and 4, which get vectorized paths. A block of 8 outputs
+// loads 8 * rate samples, the last rate - 1 of which the scalar loop never reads, so the
+// last block is always left to the scalar loop to not read past the end of src.
+static void reverb_downsample(s16 *dst, const s16 *src, s32 count, s32 rate) {
+    s32 i = 0;
+
+#if defined(__SSE2__)
+    if (rate == 2 || rate == 4) {
+        for (; i + 8 < count; i += 8) {
+            // Keep the even lanes by sign extending the low half of each 32-bit lane
+            __m128i a = _mm_loadu_si128((const __m128i *) src);
+            __m128i b = _mm_loadu_si128((const __m128i *) (src + 8));
+            __m128i even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                           _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+            if (rate == 4) {
+                __m128i c = _mm_loadu_si128((const __m128i *) (src + 16));
+                __m128i d = _mm_loadu_si128((const __m128i *) (src + 24));
+                __m128i even2 = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(c, 16), 16),
+                                                _mm_srai_epi32(_mm_slli_epi32(d, 16), 16));
+                even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(even, 16), 16),
+                                       _mm_srai_epi32(_mm_slli_epi32(even2, 16), 16));
+            }
+            _mm_storeu_si128((__m128i *) (dst + i), even);
+            src += 8 * rate;
+        }
+    }
+#elif defined(__ARM_NEON)
+    if (rate == 2) {
+        for (; i + 8 < count; i += 8) {
+            vst1q_s16(dst + i, vld2q_s16(src).val[0]);
+            src += 16;
+        }
+    } else if (rate == 4) {
+        for (; i + 8 < count; i += 8) {
+            vst1q_s16(dst + i, vld4q_s16(src).val[0]);
+            src += 32;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = *src;
+        src += rate;
+    }
+}
+#endif
+
 #if defined(VERSION_EU)
 // Equivalent functionality as the US/JP version,
 // just that the reverb structure is chosen from an array with index
@@ -112,6 +169,7 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex, s32 reverbIndex)
             // Touches both left and right since they are adjacent in memory
             osInvalDCache(item->toDownsampleLeft, DEFAULT_LEN_2CH);
 
+#ifdef TARGET_N64
             for (srcPos = 0, dstPos = 0; dstPos < item->lengthA / 2;
                  srcPos += reverb->downsampleRate, dstPos++) {
                 reverb->ringBuffer.left[item->startPos + dstPos] =
@@ -123,6 +181,18 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex, s32 reverbIndex)
                 reverb->ringBuffer.left[dstPos] = item->toDownsampleLeft[srcPos];
                 reverb->ringBuffer.right[dstPos] = item->toDownsampleRight[srcPos];
             }
+#else
+            dstPos = item->lengthA / 2;
+            srcPos = dstPos * reverb->downsampleRate;
+            reverb_downsample(&reverb->ringBuffer.left[item->startPos], item->toDownsampleLeft, dstPos,
+                              reverb->downsampleRate);
+            reverb_downsample(&reverb->ringBuffer.right[item->startPos], item->toDownsampleRight, dstPos,
+                              reverb->downsampleRate);
+            reverb_downsample(reverb->ringBuffer.left, &item->toDownsampleLeft[srcPos], item->lengthB / 2,
+                              reverb->downsampleRate);
+            reverb_downsample(reverb->ringBuffer.right, &item->toDownsampleRight[srcPos], item->lengthB / 2,
+                              reverb->downsampleRate);
+#endif
         }
     }
 
@@ -163,6 +233,7 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex) {
             // Touches both left and right since they are adjacent in memory
             osInvalDCache(item->toDownsampleLeft, DEFAULT_LEN_2CH);
 
+#ifdef TARGET_N64
             for (srcPos = 0, dstPos = 0; dstPos < item->lengthA / 2;
                  srcPos += gReverbDownsampleRate, dstPos++) {
                 gSynthesisReverb.ringBuffer.left[dstPos + item->startPos] =
@@ -174,6 +245,18 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex) {
                 gSynthesisReverb.ringBuffer.left[dstPos] = item->toDownsampleLeft[srcPos];
                 gSynthesisReverb.ringBuffer.right[dstPos] = item->toDownsampleRight[srcPos];
             }
+#else
+            dstPos = item->lengthA / 2;
+            srcPos = dstPos * gReverbDownsampleRate;
+            reverb_downsample(&gSynthesisReverb.ringBuffer.left[item->startPos], item->toDownsampleLeft, dstPos,
+                              gReverbDownsampleRate);
+            reverb_downsample(&gSynthesisReverb.ringBuffer.right[item->startPos], item->toDownsampleRight, dstPos,
+                              gReverbDownsampleRate);
+            reverb_downsample(gSynthesisReverb.ringBuffer.left, &item->toDownsampleLeft[srcPos], item->lengthB / 2,
+                              gReverbDownsampleRate);
+            reverb_downsample(gSynthesisReverb.ringBuffer.right, &item->toDownsampleRight[srcPos], item->lengthB / 2,
+                              gReverbDownsampleRate);
+#endif
         }
     }
     item = &gSynthesisReverb.items[gSynthesisReverb.curFrame][updateIndex];
@@ -300,7 +383,8 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
         gCurrentRightVolRamping = rightVolRamp;
         for (j = 0; j < gNumSynthesisReverbs; j++) {
             if (gSynthesisReverbs[j].useReverb != 0) {
-                prepare_reverb_ring_buffer(chunkLen, gAudioBufferParameters.updatesPerFrame - i, j);
+                AUDIO_PROFILER_WRAP(AUDIO_PROFILER_REVERB,
+                                    prepare_reverb_ring_buffer(chunkLen, gAudioBufferParameters.updatesPerFrame - i, j));
             }
         }
         cmd = synthesis_do_one_audio_update((s16 *) aiBufPtr, chunkLen, cmd, gAudioBufferParameters.updatesPerFrame - i);
@@ -349,7 +433,7 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
         process_sequences(i - 1);
         
         if (gSynthesisReverb.useReverb != 0) {
-            prepare_reverb_ring_buffer(chunkLen, gAudioUpdatesPerFrame - i);
+            AUDIO_PROFILER_WRAP(AUDIO_PROFILER_REVERB, prepare_reverb_ring_buffer(chunkLen, gAudioUpdatesPerFrame - i));
         }
 
         cmd = synthesis_do_one_audio_update((s16 *) aiBufPtr, chunkLen, cmd, gAudioUpdatesPerFrame - i);
@@ -438,7 +522,11 @@ u64 *synthesis_save_reverb_samples(u64 *cmdBuf, s16 reverbIndex, s16 updateIndex
 #ifdef VERSION_EU
 u64 *synthesis_do_one_audio_update(s16 *aiBuf, s32 bufLen, u64 *cmd, u32 updateIndex) {
     struct NoteSubEu *noteSubEu;
+#ifdef AUDIO_DYNAMIC_NOTES
+    u8 noteIndices[AUDIO_MAX_NOTES_LIMIT];
+#else
     u8 noteIndices[56];
+#endif
     s32 temp;
     s32 i;
     s16 j;
@@ -475,33 +563,36 @@ u64 *synthesis_do_one_audio_update(s16 *aiBuf, s32 bufLen, u64 *cmd, u32 updateI
     for (j = 0; j < gNumSynthesisReverbs; j++) {
         gUseReverb = gSynthesisReverbs[j].useReverb;
         if (gUseReverb != 0) {
-            cmd = synthesis_resample_and_mix_reverb(cmd, bufLen, j, updateIndex);
+            AUDIO_PROFILER_WRAP(AUDIO_PROFILER_REVERB,
+                                cmd = synthesis_resample_and_mix_reverb(cmd, bufLen, j, updateIndex));
         }
         for (; i < notePos; i++) {
             temp = updateIndex;
             temp *= gMaxSimultaneousNotes;
             if (j == gNoteSubsEu[temp + noteIndices[i]].reverbIndex) {
-                cmd = synthesis_process_note(&gNotes[noteIndices[i]],
-                                             &gNoteSubsEu[temp + noteIndices[i]],
-                                             &gNotes[noteIndices[i]].synthesisState,
-                                             aiBuf, bufLen, cmd);
+                AUDIO_PROFILER_WRAP(AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES,
+                                    cmd = synthesis_process_note(&gNotes[noteIndices[i]],
+                                                                 &gNoteSubsEu[temp + noteIndices[i]],
+                                                                 &gNotes[noteIndices[i]].synthesisState,
+                                                                 aiBuf, bufLen, cmd));
                 continue;
             } else {
                 break;
             }
         }
         if (gSynthesisReverbs[j].useReverb != 0) {
-            cmd = synthesis_save_reverb_samples(cmd, j, updateIndex);
+            AUDIO_PROFILER_WRAP(AUDIO_PROFILER_REVERB, cmd = synthesis_save_reverb_samples(cmd, j, updateIndex));
         }
     }
     for (; i < notePos; i++) {
         temp = updateIndex;
         temp *= gMaxSimultaneousNotes;
         if (IS_BANK_LOAD_COMPLETE(gNoteSubsEu[temp + noteIndices[i]].bankId) == TRUE) {
-            cmd = synthesis_process_note(&gNotes[noteIndices[i]],
-                                         &gNoteSubsEu[temp + noteIndices[i]],
-                                         &gNotes[noteIndices[i]].synthesisState,
-                                         aiBuf, bufLen, cmd);
+            AUDIO_PROFILER_WRAP(AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES,
+                                cmd = synthesis_process_note(&gNotes[noteIndices[i]],
+                                                             &gNoteSubsEu[temp + noteIndices[i]],
+                                                             &gNotes[noteIndices[i]].synthesisState,
+                                                             aiBuf, bufLen, cmd));
         } else {
             gAudioErrorFlags = (gNoteSubsEu[temp + noteIndices[i]].bankId + (i << 8)) + 0x10000000;
         }
@@ -557,8 +648,9 @@ u64 *synthesis_do_one_audio_update(s16 *aiBuf, s32 bufLen, u64 *cmd, u32 updateI
 
     if (gSynthesisReverb.useReverb == 0) {
         aClearBuffer(cmd++, DMEM_ADDR_LEFT_CH, DEFAULT_LEN_2CH);
-        cmd = synthesis_process_notes(aiBuf, bufLen, cmd);
+        AUDIO_PROFILER_WRAP(AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES, cmd = synthesis_process_notes(aiBuf, bufLen, cmd));
     } else {
+        AUDIO_PROFILER_BEGIN(reverbStart);
         if (gReverbDownsampleRate == 1) {
             // Put the oldest samples in the ring buffer into the wet channels
             aSetLoadBufferPair(cmd++, 0, v1->startPos);
@@ -600,7 +692,9 @@ u64 *synthesis_do_one_audio_update(s16 *aiBuf, s32 bufLen, u64 *cmd, u32 updateI
             aMix(cmd++, 0, /*gain*/ 0x8000 + gSynthesisReverb.reverbGain, /*in*/ DMEM_ADDR_LEFT_CH, /*out*/ DMEM_ADDR_LEFT_CH);
             aDMEMMove(cmd++, DMEM_ADDR_LEFT_CH, DMEM_ADDR_WET_LEFT_CH, DEFAULT_LEN_2CH);
         }
-        cmd = synthesis_process_notes(aiBuf, bufLen, cmd);
+        AUDIO_PROFILER_END(AUDIO_PROFILER_REVERB, reverbStart);
+        AUDIO_PROFILER_WRAP(AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES, cmd = synthesis_process_notes(aiBuf, bufLen, cmd));
+        AUDIO_PROFILER_BEGIN(reverbSaveStart);
         if (gReverbDownsampleRate == 1) {
             aSetSaveBufferPair(cmd++, 0, v1->lengthA, v1->startPos);
             if (v1->lengthB != 0) {
@@ -614,6 +708,7 @@ u64 *synthesis_do_one_audio_update(s16 *aiBuf, s32 bufLen, u64 *cmd, u32 updateI
             aSaveBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(gSynthesisReverb.items[gSynthesisReverb.curFrame][updateIndex].toDownsampleLeft));
             gSynthesisReverb.resampleFlags = 0;
         }
+        AUDIO_PROFILER_END(AUDIO_PROFILER_REVERB, reverbSaveStart);
     }
     return cmd;
 }
@@ -1,4 +1,7 @@
 #include <ultra64.h>
+#ifndef TARGET_N64
+#include <stdlib.h>
+#endif
 
 #include "sm64.h"
 #include "behavior_data.h"
@@ -80,6 +83,17 @@ s32 random_sign(void) {
     }
 }
 
+#ifndef TARGET_N64
+// The random seed, for tools that hash or restore the game state.
+u16 random_get_seed(void) {
+    return gRandomSeed16;
+}
+
+void random_set_seed(u16 seed) {
+    gRandomSeed16 = seed;
+}
+#endif
+
 // Update an object's graphical position and rotation to match its real position and rotation.
 void obj_update_gfx_pos_and_angle(struct Object *obj) {
     obj->header.gfx.pos[0] = obj->oPosX;
@@ -902,14 +916,792 @@ static BhvCommandProc BehaviorCmdTable[] = {
     bhv_cmd_spawn_water_droplet,
 };
 
+#ifdef BHV_THREADED_CODE
+/* Threaded code interpreter
+ *
+ * The first time a behavior command is reached, the straight-line run of commands starting
+ * there (up to a command that never falls through, like END_LOOP or GOTO) is decoded into an
+ * array of BhvInsn: the address of the handler for the command, the command's operands
+ * already unpacked, and the address of the command itself. Commands are then executed by
+ * jumping from handler to handler with computed gotos, instead of going through
+ * BehaviorCmdTable and unpacking the command words every time.
+ *
+ * The object's state is the same as with the table: curBhvCommand and the behavior stack
+ * hold script addresses, which are mapped to instructions through a hash table when the
+ * interpreter starts or returns to one. Commands that only run once per object, like the
+ * spawn and hitbox commands, are executed by calling their bhv_cmd_* function.
+ */
+#define BHV_MAX_RUN 256    // Longest run translated at once; longer runs continue in another
+#define BHV_CHUNK_SIZE 512 // Instructions per allocation
+
+enum BhvHandler {
+    BHV_OP_PROC,      // Calls the bhv_cmd_* function of the command
+    BHV_OP_INTERPRET, // Unknown command, left to the table for the rest of the frame
+    BHV_OP_LINK,      // Continues at the instruction for the next command, in another run
+    BHV_OP_DELAY,
+    BHV_OP_DELAY_VAR,
+    BHV_OP_CALL,
+    BHV_OP_RETURN,
+    BHV_OP_GOTO,
+    BHV_OP_BEGIN_REPEAT,
+    BHV_OP_END_REPEAT,
+    BHV_OP_END_REPEAT_CONTINUE,
+    BHV_OP_BEGIN_LOOP,
+    BHV_OP_END_LOOP,
+    BHV_OP_BREAK,
+    BHV_OP_DEACTIVATE,
+    BHV_OP_CALL_NATIVE,
+    BHV_OP_ADD_FLOAT,
+    BHV_OP_SET_FLOAT,
+    BHV_OP_ADD_INT,
+    BHV_OP_SET_INT,
+    BHV_OP_OR_INT,
+    BHV_OP_AND_INT,
+    BHV_OP_SET_INT_RAND_RSHIFT,
+    BHV_OP_SET_RANDOM_FLOAT,
+    BHV_OP_SET_RANDOM_INT,
+    BHV_OP_ADD_RANDOM_FLOAT,
+    BHV_OP_ADD_INT_RAND_RSHIFT,
+    BHV_OP_SUM_FLOAT,
+    BHV_OP_SUM_INT,
+    BHV_OP_NOP,
+    BHV_OP_SET_MODEL,
+    BHV_OP_BILLBOARD,
+    BHV_OP_HIDE,
+    BHV_OP_DISABLE_RENDERING,
+    BHV_OP_SET_HITBOX,
+    BHV_OP_SET_HOME,
+    BHV_OP_LOAD_ANIMATIONS,
+    BHV_OP_ANIMATE,
+    BHV_OP_ANIMATE_TEXTURE,
+    BHV_OP_PARENT_BIT_CLEAR,
+    BHV_OP_COUNT
+};
+
+struct BhvInsn {
+    const void *handler;             // Label in bhv_run_threaded
+    const BehaviorScript *cmd;       // The command this was decoded from
+    struct BhvInsn *target;          // Jump target, looked up the first time it's taken
+    union {
+        BhvCommandProc proc;
+        NativeBhvFunc func;
+        void *ptr;
+    } p;
+    union {
+        s32 i;
+        f32 f;
+    } a, b;
+    u8 field;
+    u8 field2;
+    u8 field3;
+};
+
+struct BhvTableEntry {
+    const BehaviorScript *cmd;
+    struct BhvInsn *insn;
+};
+
+static const void *const *sBhvHandlers;
+
+// Open addressed table of every translated instruction, keyed by the command address
+static struct BhvTableEntry *sBhvTable;
+static u32 sBhvTableSize;
+static u32 sBhvTableCount;
+
+// The instruction each object in the pool stopped at, checked against its curBhvCommand
+static struct BhvInsn *sBhvResume[OBJECT_POOL_CAPACITY];
+
+static struct BhvInsn *sBhvChunk;
+static u32 sBhvChunkLeft;
+
+static u32 bhv_table_hash(const BehaviorScript *cmd) {
+    return ((uintptr_t) cmd / sizeof(BehaviorScript)) * 2654435761u;
+}
+
+static struct BhvInsn *bhv_table_find(const BehaviorScript *cmd) {
+    u32 i;
+
+    if (sBhvTable == NULL) {
+        return NULL;
+    }
+    for (i = bhv_table_hash(cmd) & (sBhvTableSize - 1); sBhvTable[i].cmd != NULL; i = (i + 1) & (sBhvTableSize - 1)) {
+        if (sBhvTable[i].cmd == cmd) {
+            return sBhvTable[i].insn;
+        }
+    }
+    return NULL;
+}
+
+static void bhv_table_insert(struct BhvInsn *insn) {
+    u32 i = bhv_table_hash(insn->cmd) & (sBhvTableSize - 1);
+
+    while (sBhvTable[i].cmd != NULL) {
+        i = (i + 1) & (sBhvTableSize - 1);
+    }
+    sBhvTable[i].cmd = insn->cmd;
+    sBhvTable[i].insn = insn;
+    sBhvTableCount++;
+}
+
+/**
+ * Make room for count more entries in the table, keeping it at most half full.
+ */
+static s32 bhv_table_reserve(u32 count) {
+    struct BhvTableEntry *oldTable = sBhvTable;
+    u32 oldSize = sBhvTableSize;
+    u32 size = oldSize != 0 ? oldSize : 4096;
+    u32 i;
+
+    while ((sBhvTableCount + count) * 2 > size) {
+        size *= 2;
+    }
+    if (size == oldSize) {
+        return TRUE;
+    }
+    if ((sBhvTable = calloc(size, sizeof(struct BhvTableEntry))) == NULL) {
+        sBhvTable = oldTable;
+        return FALSE;
+    }
+    sBhvTableSize = size;
+    sBhvTableCount = 0;
+    for (i = 0; i < oldSize; i++) {
+        if (oldTable[i].cmd != NULL) {
+            bhv_table_insert(oldTable[i].insn);
+        }
+    }
+    free(oldTable);
+    return TRUE;
+}
+
+/**
+ * Decode the command at cmd into insn. Return the length of the command in words,
+ * or 0 if execution never falls through to the next command.
+ */
+static s32 bhv_decode(struct BhvInsn *insn, const BehaviorScript *cmd) {
+    u32 op = cmd[0] >> 24;
+    u32 handler = BHV_OP_PROC;
+    s32 length = 1;
+
+    insn->cmd = cmd;
+    insn->target = NULL;
+    insn->p.ptr = NULL;
+    insn->a.i = 0;
+    insn->b.i = 0;
+    insn->field = (u8)((cmd[0] >> 16) & 0xFF);
+    insn->field2 = (u8)((cmd[0] >> 8) & 0xFF);
+    insn->field3 = (u8)(cmd[0] & 0xFF);
+
+    if (op >= (u32) ARRAY_COUNT(BehaviorCmdTable)) {
+        insn->handler = sBhvHandlers[BHV_OP_INTERPRET];
+        return 0;
+    }
+    insn->p.proc = BehaviorCmdTable[op];
+
+    switch (op) {
+        case 0x01:
+            handler = BHV_OP_DELAY;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x02:
+            handler = BHV_OP_CALL;
+            insn->p.ptr = segmented_to_virtual((void *) cmd[1]);
+            length = 2;
+            break;
+        case 0x03:
+            handler = BHV_OP_RETURN;
+            length = 0;
+            break;
+        case 0x04:
+            handler = BHV_OP_GOTO;
+            insn->p.ptr = segmented_to_virtual((void *) cmd[1]);
+            length = 0;
+            break;
+        case 0x05:
+            handler = BHV_OP_BEGIN_REPEAT;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x06:
+            handler = BHV_OP_END_REPEAT;
+            break;
+        case 0x07:
+            handler = BHV_OP_END_REPEAT_CONTINUE;
+            break;
+        case 0x08:
+            handler = BHV_OP_BEGIN_LOOP;
+            break;
+        case 0x09:
+            handler = BHV_OP_END_LOOP;
+            length = 0;
+            break;
+        case 0x0A:
+        case 0x0B:
+            handler = BHV_OP_BREAK;
+            length = 0;
+            break;
+        case 0x0C:
+            handler = BHV_OP_CALL_NATIVE;
+            insn->p.func = (NativeBhvFunc) cmd[1];
+            length = 2;
+            break;
+        case 0x0D:
+        case 0x0E:
+            handler = op == 0x0D ? BHV_OP_ADD_FLOAT : BHV_OP_SET_FLOAT;
+            insn->a.f = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x0F:
+        case 0x10:
+            handler = op == 0x0F ? BHV_OP_ADD_INT : BHV_OP_SET_INT;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x11:
+            handler = BHV_OP_OR_INT;
+            insn->a.i = cmd[0] & 0xFFFF;
+            break;
+        case 0x12:
+            handler = BHV_OP_AND_INT;
+            insn->a.i = (cmd[0] & 0xFFFF) ^ 0xFFFF;
+            break;
+        case 0x13:
+        case 0x17:
+            handler = op == 0x13 ? BHV_OP_SET_INT_RAND_RSHIFT : BHV_OP_ADD_INT_RAND_RSHIFT;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            insn->b.i = (s16)(cmd[1] >> 16);
+            length = 2;
+            break;
+        case 0x14:
+        case 0x16:
+            handler = op == 0x14 ? BHV_OP_SET_RANDOM_FLOAT : BHV_OP_ADD_RANDOM_FLOAT;
+            insn->a.f = (s16)(cmd[0] & 0xFFFF);
+            insn->b.f = (s16)(cmd[1] >> 16);
+            length = 2;
+            break;
+        case 0x15:
+            handler = BHV_OP_SET_RANDOM_INT;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            insn->b.i = (s16)(cmd[1] >> 16);
+            length = 2;
+            break;
+        case 0x18:
+        case 0x19:
+        case 0x1A:
+        case 0x24:
+            handler = BHV_OP_NOP;
+            break;
+        case 0x1B:
+            handler = BHV_OP_SET_MODEL;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x1C:
+        case 0x29:
+        case 0x2C:
+            length = 3;
+            break;
+        case 0x1D:
+            handler = BHV_OP_DEACTIVATE;
+            length = 0;
+            break;
+        case 0x1F:
+            handler = BHV_OP_SUM_FLOAT;
+            break;
+        case 0x20:
+            handler = BHV_OP_SUM_INT;
+            break;
+        case 0x21:
+            handler = BHV_OP_BILLBOARD;
+            break;
+        case 0x22:
+            handler = BHV_OP_HIDE;
+            break;
+        case 0x23:
+            handler = BHV_OP_SET_HITBOX;
+            insn->a.f = (s16)(cmd[1] >> 16);
+            insn->b.f = (s16)(cmd[1] & 0xFFFF);
+            length = 2;
+            break;
+        case 0x25:
+            handler = BHV_OP_DELAY_VAR;
+            break;
+        case 0x26:
+            handler = BHV_OP_BEGIN_REPEAT;
+            insn->a.i = (u8)((cmd[0] >> 16) & 0xFF);
+            break;
+        case 0x27:
+            handler = BHV_OP_LOAD_ANIMATIONS;
+            insn->p.ptr = (void *) cmd[1];
+            length = 2;
+            break;
+        case 0x28:
+            handler = BHV_OP_ANIMATE;
+            break;
+        case 0x2B:
+            length = 3;
+            break;
+        case 0x2D:
+            handler = BHV_OP_SET_HOME;
+            break;
+        case 0x30:
+            length = 5;
+            break;
+        case 0x33:
+            handler = BHV_OP_PARENT_BIT_CLEAR;
+            insn->a.i = (s32)(u32) cmd[1] ^ 0xFFFFFFFF;
+            length = 2;
+            break;
+        case 0x34:
+            handler = BHV_OP_ANIMATE_TEXTURE;
+            insn->a.i = (s16)(cmd[0] & 0xFFFF);
+            break;
+        case 0x35:
+            handler = BHV_OP_DISABLE_RENDERING;
+            break;
+        case 0x2A:
+        case 0x2E:
+        case 0x2F:
+        case 0x31:
+        case 0x36:
+        case 0x37:
+            length = 2;
+            break;
+        default:
+            // BEGIN, DROP_TO_FLOOR and SCALE
+            break;
+    }
+
+    insn->handler = sBhvHandlers[handler];
+    return length;
+}
+
+/**
+ * Translate the run of commands starting at start, and return its first instruction,
+ * or NULL if out of memory.
+ */
+static struct BhvInsn *bhv_translate(const BehaviorScript *start) {
+    static struct BhvInsn run[BHV_MAX_RUN];
+    const BehaviorScript *cmd = start;
+    struct BhvInsn *insns;
+    s32 count = 0;
+    s32 i;
+
+    for (;;) {
+        struct BhvInsn *existing;
+        s32 length;
+
+        // Falling through into a command that's already translated, or past the longest run
+        if (count > 0 && ((existing = bhv_table_find(cmd)) != NULL || count == BHV_MAX_RUN - 1)) {
+            run[count].handler = sBhvHandlers[BHV_OP_LINK];
+            run[count].cmd = cmd;
+            run[count].target = existing;
+            count++;
+            break;
+        }
+
+        length = bhv_decode(&run[count++], cmd);
+        if (length == 0) {
+            break;
+        }
+        cmd += length;
+    }
+
+    if (!bhv_table_reserve(count)) {
+        return NULL;
+    }
+    if (sBhvChunkLeft < (u32) count) {
+        u32 size = count > BHV_CHUNK_SIZE ? count : BHV_CHUNK_SIZE;
+
+        if ((sBhvChunk = malloc(size * sizeof(struct BhvInsn))) == NULL) {
+            sBhvChunkLeft = 0;
+            return NULL;
+        }
+        sBhvChunkLeft = size;
+    }
+    insns = sBhvChunk;
+    sBhvChunk += count;
+    sBhvChunkLeft -= count;
+
+    for (i = 0; i < count; i++) {
+        insns[i] = run[i];
+        if (insns[i].handler != sBhvHandlers[BHV_OP_LINK]) {
+            bhv_table_insert(&insns[i]);
+        }
+    }
+    return insns;
+}
+
+static struct BhvInsn *bhv_lookup(const BehaviorScript *cmd) {
+    struct BhvInsn *insn = bhv_table_find(cmd);
+
+    if (insn == NULL) {
+        insn = bhv_translate(cmd);
+    }
+    return insn;
+}
+
+// The command table loop, for commands the translator doesn't know and if memory runs out
+void bhv_run_table(void) {
+    s32 bhvProcResult;
+
+    do {
+        bhvProcResult = BehaviorCmdTable[*gCurBhvCommand >> 24]();
+    } while (bhvProcResult == BHV_PROC_CONTINUE);
+}
+
+// Continue at the instruction for the script address cmd
+#define BHV_JUMP(address)                                                                       \
+    {                                                                                           \
+        const BehaviorScript *jumpCmd = (address);                                              \
+        if ((insn = bhv_lookup(jumpCmd)) == NULL) {                                             \
+            gCurBhvCommand = jumpCmd;                                                           \
+            bhv_run_table();                                                                    \
+            return;                                                                             \
+        }                                                                                       \
+        goto *insn->handler;                                                                    \
+    }
+
+// Continue at the fixed target of the current instruction
+#define BHV_JUMP_TARGET(address)                                                                \
+    {                                                                                           \
+        if (insn->target == NULL && (insn->target = bhv_lookup(address)) == NULL) {             \
+            gCurBhvCommand = (address);                                                         \
+            bhv_run_table();                                                                    \
+            return;                                                                             \
+        }                                                                                       \
+        insn = insn->target;                                                                    \
+        goto *insn->handler;                                                                    \
+    }
+
+#define BHV_NEXT()                                                                              \
+    {                                                                                           \
+        insn++;                                                                                 \
+        goto *insn->handler;                                                                    \
+    }
+
+// Continue at a popped address, with the instruction for it cached in insn->target
+#define BHV_JUMP_CACHED(address)                                                                \
+    {                                                                                           \
+        const BehaviorScript *jumpCmd = (address);                                              \
+        if (insn->target == NULL || insn->target->cmd != jumpCmd) {                             \
+            if ((insn->target = bhv_lookup(jumpCmd)) == NULL) {                                 \
+                gCurBhvCommand = jumpCmd;                                                       \
+                bhv_run_table();                                                                \
+                return;                                                                         \
+            }                                                                                   \
+        }                                                                                       \
+        insn = insn->target;                                                                    \
+        goto *insn->handler;                                                                    \
+    }
+
+// Stop until next frame, resuming at the instruction next
+#define BHV_STOP(next)                                                                          \
+    {                                                                                           \
+        struct BhvInsn *stopInsn = (next);                                                      \
+        gCurBhvCommand = stopInsn->cmd;                                                         \
+        if (resume != NULL) {                                                                   \
+            *resume = stopInsn;                                                                 \
+        }                                                                                       \
+        return;                                                                                 \
+    }
+
+// Stop until next frame, resuming at a popped address, with the instruction for it cached
+// in insn->target
+#define BHV_STOP_AT(address)                                                                    \
+    {                                                                                           \
+        const BehaviorScript *stopCmd = (address);                                              \
+        if (insn->target == NULL || insn->target->cmd != stopCmd) {                             \
+            if ((insn->target = bhv_lookup(stopCmd)) == NULL) {                                 \
+                gCurBhvCommand = stopCmd;                                                       \
+                return;                                                                         \
+            }                                                                                   \
+        }                                                                                       \
+        BHV_STOP(insn->target);                                                                 \
+    }
+
+/**
+ * Execute the current object's behavior script from gCurBhvCommand until a command
+ * breaks, like the BehaviorCmdTable loop does, and leave gCurBhvCommand at the command
+ * to resume at.
+ */
+void bhv_run_threaded(void) {
+    static const void *const handlers[BHV_OP_COUNT] = {
+        [BHV_OP_PROC] = &&op_proc,
+        [BHV_OP_INTERPRET] = &&op_interpret,
+        [BHV_OP_LINK] = &&op_link,
+        [BHV_OP_DELAY] = &&op_delay,
+        [BHV_OP_DELAY_VAR] = &&op_delay_var,
+        [BHV_OP_CALL] = &&op_call,
+        [BHV_OP_RETURN] = &&op_return,
+        [BHV_OP_GOTO] = &&op_goto,
+        [BHV_OP_BEGIN_REPEAT] = &&op_begin_repeat,
+        [BHV_OP_END_REPEAT] = &&op_end_repeat,
+        [BHV_OP_END_REPEAT_CONTINUE] = &&op_end_repeat_continue,
+        [BHV_OP_BEGIN_LOOP] = &&op_begin_loop,
+        [BHV_OP_END_LOOP] = &&op_end_loop,
+        [BHV_OP_BREAK] = &&op_break,
+        [BHV_OP_DEACTIVATE] = &&op_deactivate,
+        [BHV_OP_CALL_NATIVE] = &&op_call_native,
+        [BHV_OP_ADD_FLOAT] = &&op_add_float,
+        [BHV_OP_SET_FLOAT] = &&op_set_float,
+        [BHV_OP_ADD_INT] = &&op_add_int,
+        [BHV_OP_SET_INT] = &&op_set_int,
+        [BHV_OP_OR_INT] = &&op_or_int,
+        [BHV_OP_AND_INT] = &&op_and_int,
+        [BHV_OP_SET_INT_RAND_RSHIFT] = &&op_set_int_rand_rshift,
+        [BHV_OP_SET_RANDOM_FLOAT] = &&op_set_random_float,
+        [BHV_OP_SET_RANDOM_INT] = &&op_set_random_int,
+        [BHV_OP_ADD_RANDOM_FLOAT] = &&op_add_random_float,
+        [BHV_OP_ADD_INT_RAND_RSHIFT] = &&op_add_int_rand_rshift,
+        [BHV_OP_SUM_FLOAT] = &&op_sum_float,
+        [BHV_OP_SUM_INT] = &&op_sum_int,
+        [BHV_OP_NOP] = &&op_nop,
+        [BHV_OP_SET_MODEL] = &&op_set_model,
+        [BHV_OP_BILLBOARD] = &&op_billboard,
+        [BHV_OP_HIDE] = &&op_hide,
+        [BHV_OP_DISABLE_RENDERING] = &&op_disable_rendering,
+        [BHV_OP_SET_HITBOX] = &&op_set_hitbox,
+        [BHV_OP_SET_HOME] = &&op_set_home,
+        [BHV_OP_LOAD_ANIMATIONS] = &&op_load_animations,
+        [BHV_OP_ANIMATE] = &&op_animate,
+        [BHV_OP_ANIMATE_TEXTURE] = &&op_animate_texture,
+        [BHV_OP_PARENT_BIT_CLEAR] = &&op_parent_bit_clear,
+    };
+    struct BhvInsn **resume = NULL;
+    struct BhvInsn *insn;
+    uintptr_t slot = ((uintptr_t) gCurrentObject - (uintptr_t) gObjectPool) / sizeof(struct Object);
+    uintptr_t addr;
+    u32 count;
+    s32 num;
+
+    sBhvHandlers = handlers;
+    if (slot < OBJECT_POOL_CAPACITY) {
+        resume = &sBhvResume[slot];
+        if (*resume != NULL && (*resume)->cmd == gCurBhvCommand) {
+            insn = *resume;
+            goto *insn->handler;
+        }
+    }
+    BHV_JUMP(gCurBhvCommand);
+
+op_proc:
+    gCurBhvCommand = insn->cmd;
+    if (insn->p.proc() != BHV_PROC_CONTINUE) {
+        return;
+    }
+    if (gCurBhvCommand == insn[1].cmd) {
+        BHV_NEXT();
+    }
+    BHV_JUMP(gCurBhvCommand);
+
+op_interpret:
+    gCurBhvCommand = insn->cmd;
+    bhv_run_table();
+    return;
+
+op_link:
+    BHV_JUMP_TARGET(insn->cmd);
+
+op_delay:
+    if (gCurrentObject->bhvDelayTimer < insn->a.i - 1) {
+        gCurrentObject->bhvDelayTimer++;
+        BHV_STOP(insn);
+    }
+    gCurrentObject->bhvDelayTimer = 0;
+    BHV_STOP(insn + 1);
+
+op_delay_var:
+    num = cur_obj_get_int(insn->field);
+    if (gCurrentObject->bhvDelayTimer < num - 1) {
+        gCurrentObject->bhvDelayTimer++;
+        BHV_STOP(insn);
+    }
+    gCurrentObject->bhvDelayTimer = 0;
+    BHV_STOP(insn + 1);
+
+op_call:
+    cur_obj_bhv_stack_push((uintptr_t) &insn->cmd[2]);
+    BHV_JUMP_TARGET(insn->p.ptr);
+
+op_return:
+    BHV_JUMP_CACHED((const BehaviorScript *) cur_obj_bhv_stack_pop());
+
+op_goto:
+    BHV_JUMP_TARGET(insn->p.ptr);
+
+op_begin_repeat:
+    cur_obj_bhv_stack_push((uintptr_t) &insn->cmd[1]);
+    cur_obj_bhv_stack_push(insn->a.i);
+    BHV_NEXT();
+
+op_end_repeat:
+    count = cur_obj_bhv_stack_pop() - 1;
+    if (count != 0) {
+        addr = cur_obj_bhv_stack_pop();
+        cur_obj_bhv_stack_push(addr);
+        cur_obj_bhv_stack_push(count);
+        BHV_STOP_AT((const BehaviorScript *) addr);
+    }
+    cur_obj_bhv_stack_pop();
+    BHV_STOP(insn + 1);
+
+op_end_repeat_continue:
+    count = cur_obj_bhv_stack_pop() - 1;
+    if (count != 0) {
+        addr = cur_obj_bhv_stack_pop();
+        cur_obj_bhv_stack_push(addr);
+        cur_obj_bhv_stack_push(count);
+        BHV_JUMP_CACHED((const BehaviorScript *) addr);
+    }
+    cur_obj_bhv_stack_pop();
+    BHV_NEXT();
+
+op_begin_loop:
+    cur_obj_bhv_stack_push((uintptr_t) &insn->cmd[1]);
+    BHV_NEXT();
+
+op_end_loop:
+    addr = cur_obj_bhv_stack_pop();
+    cur_obj_bhv_stack_push(addr);
+    BHV_STOP_AT((const BehaviorScript *) addr);
+
+op_break:
+    BHV_STOP(insn);
+
+op_deactivate:
+    gCurrentObject->activeFlags = ACTIVE_FLAG_DEACTIVATED;
+    BHV_STOP(insn);
+
+op_call_native:
+    insn->p.func();
+    BHV_NEXT();
+
+op_add_float:
+    cur_obj_add_float(insn->field, insn->a.f);
+    BHV_NEXT();
+
+op_set_float:
+    cur_obj_set_float(insn->field, insn->a.f);
+    BHV_NEXT();
+
+op_add_int:
+    cur_obj_add_int(insn->field, insn->a.i);
+    BHV_NEXT();
+
+op_set_int:
+    cur_obj_set_int(insn->field, insn->a.i);
+    BHV_NEXT();
+
+op_or_int:
+    cur_obj_or_int(insn->field, insn->a.i);
+    BHV_NEXT();
+
+op_and_int:
+    cur_obj_and_int(insn->field, insn->a.i);
+    BHV_NEXT();
+
+op_set_int_rand_rshift:
+    cur_obj_set_int(insn->field, (random_u16() >> insn->b.i) + insn->a.i);
+    BHV_NEXT();
+
+op_set_random_float:
+    cur_obj_set_float(insn->field, (insn->b.f * random_float()) + insn->a.f);
+    BHV_NEXT();
+
+op_set_random_int:
+    cur_obj_set_int(insn->field, (s32)(insn->b.i * random_float()) + insn->a.i);
+    BHV_NEXT();
+
+op_add_random_float:
+    cur_obj_set_float(insn->field, cur_obj_get_float(insn->field) + insn->a.f + (insn->b.f * random_float()));
+    BHV_NEXT();
+
+op_add_int_rand_rshift:
+    num = random_u16();
+    cur_obj_set_int(insn->field, (cur_obj_get_int(insn->field) + insn->a.i) + (num >> insn->b.i));
+    BHV_NEXT();
+
+op_sum_float:
+    cur_obj_set_float(insn->field, cur_obj_get_float(insn->field2) + cur_obj_get_float(insn->field3));
+    BHV_NEXT();
+
+op_sum_int:
+    cur_obj_set_int(insn->field, cur_obj_get_int(insn->field2) + cur_obj_get_int(insn->field3));
+    BHV_NEXT();
+
+op_nop:
+    BHV_NEXT();
+
+op_set_model:
+    gCurrentObject->header.gfx.sharedChild = gLoadedGraphNodes[insn->a.i];
+    BHV_NEXT();
+
+op_billboard:
+    gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_BILLBOARD;
+    BHV_NEXT();
+
+op_hide:
+    cur_obj_hide();
+    BHV_NEXT();
+
+op_disable_rendering:
+    gCurrentObject->header.gfx.node.flags &= ~GRAPH_RENDER_ACTIVE;
+    BHV_NEXT();
+
+op_set_hitbox:
+    gCurrentObject->hitboxRadius = insn->a.f;
+    gCurrentObject->hitboxHeight = insn->b.f;
+    BHV_NEXT();
+
+op_set_home:
+    gCurrentObject->oHomeX = gCurrentObject->oPosX;
+    gCurrentObject->oHomeY = gCurrentObject->oPosY;
+    gCurrentObject->oHomeZ = gCurrentObject->oPosZ;
+    BHV_NEXT();
+
+op_load_animations:
+    cur_obj_set_vptr(insn->field, insn->p.ptr);
+    BHV_NEXT();
+
+op_animate:
+    geo_obj_init_animation(&gCurrentObject->header.gfx,
+                           &((struct Animation **) gCurrentObject->oAnimations)[insn->field]);
+    BHV_NEXT();
+
+op_animate_texture:
+    if ((gGlobalTimer % insn->a.i) == 0) {
+        cur_obj_add_int(insn->field, 1);
+    }
+    BHV_NEXT();
+
+op_parent_bit_clear:
+    obj_and_int(gCurrentObject->parentObj, insn->field, insn->a.i);
+    BHV_NEXT();
+}
+#endif
+
+#ifndef TARGET_N64
+// Save states leave the translated code alone. It's a cache of the scripts, and its table is
+// reallocated as it grows, so an older copy of these pointers could be dangling.
+void bhv_savestate_exclude(void (*exclude)(void *addr, u32 size)) {
+#ifdef BHV_THREADED_CODE
+    exclude(&sBhvTable, sizeof(sBhvTable));
+    exclude(&sBhvTableSize, sizeof(sBhvTableSize));
+    exclude(&sBhvTableCount, sizeof(sBhvTableCount));
+    exclude(&sBhvChunk, sizeof(sBhvChunk));
+    exclude(&sBhvChunkLeft, sizeof(sBhvChunkLeft));
+#else
+    (void) exclude;
+#endif
+}
+#endif
+
 // Execute the behavior script of the current object, process the object flags, and other miscellaneous code for updating objects.
 void cur_obj_update(void) {
     UNUSED u32 unused;
 
     s16 objFlags = gCurrentObject->oFlags;
     f32 distanceFromMario;
+#ifndef BHV_THREADED_CODE
     BhvCommandProc bhvCmdProc;
     s32 bhvProcResult;
+#endif
 
     // Calculate the distance from the object to Mario.
     if (objFlags & OBJ_FLAG_COMPUTE_DIST_TO_MARIO) {
@@ -933,10 +1725,14 @@ void cur_obj_update(void) {
     // Execute the behavior script.
     gCurBhvCommand = gCurrentObject->curBhvCommand;
 
+#ifdef BHV_THREADED_CODE
+    bhv_run_threaded();
+#else
     do {
         bhvCmdProc = BehaviorCmdTable[*gCurBhvCommand >> 24];
         bhvProcResult = bhvCmdProc();
     } while (bhvProcResult == BHV_PROC_CONTINUE);
+#endif
 
     gCurrentObject->curBhvCommand = gCurBhvCommand;
 
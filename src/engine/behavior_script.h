@@ -6,6 +6,14 @@
 #define BHV_PROC_CONTINUE 0
 #define BHV_PROC_BREAK    1
 
+// Outside of N64 builds, behavior scripts are translated to pre-decoded instructions that
+// are dispatched with computed gotos, a GCC extension. See bhv_run_threaded. The
+// BehaviorCmdTable loop is kept as bhv_run_table, which sm64_behavior_script_bench checks
+// the threaded code against.
+#if !defined(TARGET_N64) && defined(__GNUC__)
+#define BHV_THREADED_CODE
+#endif
+
 #define cur_obj_get_int(offset) gCurrentObject->OBJECT_FIELD_S32(offset)
 #define cur_obj_get_float(offset) gCurrentObject->OBJECT_FIELD_F32(offset)
 
@@ -22,9 +30,19 @@
 u16 random_u16(void);
 float random_float(void);
 s32 random_sign(void);
+#ifndef TARGET_N64
+u16 random_get_seed(void);
+void random_set_seed(u16 seed);
+void bhv_savestate_exclude(void (*exclude)(void *addr, u32 size));
+#endif
 
 void stub_behavior_script_2(void);
 
 void cur_obj_update(void);
 
+#ifdef BHV_THREADED_CODE
+void bhv_run_threaded(void);
+void bhv_run_table(void);
+#endif
+
 #endif // BEHAVIOR_SCRIPT_H
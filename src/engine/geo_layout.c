@@ -1,4 +1,8 @@
 #include <ultra64.h>
+#ifndef TARGET_N64
+#include <stdlib.h>
+#include <string.h>
+#endif
 #include "sm64.h"
 
 #include "geo_layout.h"
@@ -102,6 +106,163 @@ u8 *gGeoLayoutCommand;
 
 u32 unused_8038B894[3] = { 0 };
 
+#ifndef TARGET_N64
+/* Geo layout cache
+ *
+ * The first time a geo layout is processed, the nodes it created are copied out of the pool
+ * into a template. Since an AllocOnlyPool hands out memory in order, the nodes of one layout
+ * are a contiguous run of the pool, linked to each other by pointers into that run. Later
+ * loads of the same layout copy the template into the pool in one go and move those links
+ * by the distance between the two copies, instead of interpreting the layout again.
+ *
+ * Layouts that deal with gGeoViews (area layouts, which have a root and camera node) are
+ * only loaded once per area, and aren't cached. Neither are layouts whose callbacks allocate
+ * from the pool, which shows up as memory between the nodes that isn't a node.
+ */
+#define GEO_LAYOUT_CACHE_SIZE 2048 // Power of two
+
+struct GeoLayoutTemplate {
+    const void *layout; // Virtual address of the geo layout
+    u8 *data;           // The nodes, linked as they were at base
+    u8 *base;           // Where the nodes were in the pool when they were copied
+    u32 size;
+    u32 rootOffset;
+    s32 uncacheable;
+};
+
+static struct GeoLayoutTemplate sGeoLayoutCache[GEO_LAYOUT_CACHE_SIZE];
+static s32 sGeoLayoutUncacheable; // Set by the commands that use gGeoViews
+
+static struct GeoLayoutTemplate *geo_layout_cache_find(const void *layout) {
+    u32 i = ((uintptr_t) layout >> 2) * 2654435761u;
+    u32 probe;
+
+    for (probe = 0; probe < GEO_LAYOUT_CACHE_SIZE; probe++) {
+        struct GeoLayoutTemplate *entry = &sGeoLayoutCache[(i + probe) & (GEO_LAYOUT_CACHE_SIZE - 1)];
+
+        if (entry->layout == layout || entry->layout == NULL) {
+            entry->layout = layout;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Return the size a node takes in an AllocOnlyPool, or 0 for types that
+ * cached layouts can't have.
+ */
+static u32 geo_layout_node_size(s16 type) {
+    u32 size;
+
+    switch (type) {
+        case GRAPH_NODE_TYPE_ORTHO_PROJECTION:     size = sizeof(struct GraphNodeOrthoProjection); break;
+        case GRAPH_NODE_TYPE_PERSPECTIVE:          size = sizeof(struct GraphNodePerspective); break;
+        case GRAPH_NODE_TYPE_MASTER_LIST:          size = sizeof(struct GraphNodeMasterList); break;
+        case GRAPH_NODE_TYPE_START:                size = sizeof(struct GraphNodeStart); break;
+        case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL:      size = sizeof(struct GraphNodeLevelOfDetail); break;
+        case GRAPH_NODE_TYPE_SWITCH_CASE:          size = sizeof(struct GraphNodeSwitchCase); break;
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION: size = sizeof(struct GraphNodeTranslationRotation); break;
+        case GRAPH_NODE_TYPE_TRANSLATION:          size = sizeof(struct GraphNodeTranslation); break;
+        case GRAPH_NODE_TYPE_ROTATION:             size = sizeof(struct GraphNodeRotation); break;
+        case GRAPH_NODE_TYPE_ANIMATED_PART:        size = sizeof(struct GraphNodeAnimatedPart); break;
+        case GRAPH_NODE_TYPE_BILLBOARD:            size = sizeof(struct GraphNodeBillboard); break;
+        case GRAPH_NODE_TYPE_DISPLAY_LIST:         size = sizeof(struct GraphNodeDisplayList); break;
+        case GRAPH_NODE_TYPE_SCALE:                size = sizeof(struct GraphNodeScale); break;
+        case GRAPH_NODE_TYPE_SHADOW:               size = sizeof(struct GraphNodeShadow); break;
+        case GRAPH_NODE_TYPE_OBJECT_PARENT:        size = sizeof(struct GraphNodeObjectParent); break;
+        case GRAPH_NODE_TYPE_GENERATED_LIST:       size = sizeof(struct GraphNodeGenerated); break;
+        case GRAPH_NODE_TYPE_BACKGROUND:           size = sizeof(struct GraphNodeBackground); break;
+        case GRAPH_NODE_TYPE_HELD_OBJ:             size = sizeof(struct GraphNodeHeldObject); break;
+        case GRAPH_NODE_TYPE_CULLING_RADIUS:       size = sizeof(struct GraphNodeCullingRadius); break;
+        default:                                   return 0;
+    }
+    return (size + 3) & ~3;
+}
+
+/**
+ * Copy the nodes a layout created in [start, end) of the pool to its template, if the
+ * range is made of nothing but nodes.
+ */
+static void geo_layout_cache_store(struct GeoLayoutTemplate *entry, u8 *start, u8 *end,
+                                   struct GraphNode *root) {
+    u8 *pos = start;
+
+    entry->uncacheable = TRUE;
+    if (sGeoLayoutUncacheable || root == NULL || end <= start) {
+        return;
+    }
+    while (pos < end) {
+        u32 size = geo_layout_node_size(((struct GraphNode *) pos)->type);
+
+        if (size == 0) {
+            return;
+        }
+        pos += size;
+    }
+    if (pos != end || (entry->data = malloc(end - start)) == NULL) {
+        return;
+    }
+    memcpy(entry->data, start, end - start);
+    entry->base = start;
+    entry->size = end - start;
+    entry->rootOffset = (u8 *) root - start;
+    entry->uncacheable = FALSE;
+}
+
+#define GEO_LAYOUT_RELOCATE(ptr)                                                                       \
+    if ((u8 *) (ptr) >= entry->base && (u8 *) (ptr) < entry->base + entry->size) {                   \
+        (ptr) = (void *) ((u8 *) (ptr) + delta);                                                       \
+    }
+
+/**
+ * Create the nodes of a cached layout in the pool. Return the root node, or NULL if
+ * the pool is out of space.
+ */
+static struct GraphNode *geo_layout_cache_instantiate(struct AllocOnlyPool *pool,
+                                                      struct GeoLayoutTemplate *entry) {
+    u8 *start = alloc_only_pool_alloc(pool, entry->size);
+    u8 *pos;
+    ptrdiff_t delta;
+
+    if (start == NULL) {
+        return NULL;
+    }
+    memcpy(start, entry->data, entry->size);
+    delta = start - entry->base;
+
+    for (pos = start; pos < start + entry->size; pos += geo_layout_node_size(((struct GraphNode *) pos)->type)) {
+        struct GraphNode *node = (struct GraphNode *) pos;
+
+        GEO_LAYOUT_RELOCATE(node->prev);
+        GEO_LAYOUT_RELOCATE(node->next);
+        GEO_LAYOUT_RELOCATE(node->parent);
+        GEO_LAYOUT_RELOCATE(node->children);
+        if (node->type == GRAPH_NODE_TYPE_OBJECT_PARENT) {
+            GEO_LAYOUT_RELOCATE(((struct GraphNodeObjectParent *) node)->sharedChild);
+        }
+    }
+
+    // The callbacks were called when the nodes were created, so call them again in the same order
+    for (pos = start; pos < start + entry->size; pos += geo_layout_node_size(((struct GraphNode *) pos)->type)) {
+        struct FnGraphNode *node = (struct FnGraphNode *) pos;
+
+        if ((node->node.type & GRAPH_NODE_TYPE_FUNCTIONAL) && node->func != NULL) {
+            node->func(GEO_CONTEXT_CREATE, &node->node, pool);
+        }
+    }
+    return (struct GraphNode *) (start + entry->rootOffset);
+}
+
+#undef GEO_LAYOUT_RELOCATE
+
+// The templates are a cache of the layouts, kept out of save states like the
+// behavior script translations
+void geo_layout_savestate_exclude(void (*exclude)(void *addr, u32 size)) {
+    exclude(sGeoLayoutCache, sizeof(sGeoLayoutCache));
+}
+#endif
+
 /*
   0x00: Branch and store return address
    cmd+0x04: void *branchTarget
@@ -160,6 +321,10 @@ void geo_layout_cmd_close_node(void) {
 void geo_layout_cmd_assign_as_view(void) {
     u16 index = cur_geo_cmd_s16(0x02);
 
+#ifndef TARGET_N64
+    sGeoLayoutUncacheable = TRUE;
+#endif
+
     if (index < gGeoNumViews) {
         gGeoViews[index] = gCurGraphNodeList[gCurGraphNodeIndex];
     }
@@ -212,6 +377,9 @@ void geo_layout_cmd_node_root(void) {
     // at least 2 are allocated by default
     // cmd+0x02 = 0x00: Mario face, 0x0A: all other levels
     gGeoNumViews = cur_geo_cmd_s16(0x02) + 2;
+#ifndef TARGET_N64
+    sGeoLayoutUncacheable = TRUE;
+#endif
 
     graphNode = init_graph_node_root(gGraphNodePool, NULL, 0, x, y, width, height);
 
@@ -373,6 +541,9 @@ void geo_layout_cmd_node_camera(void) {
     register_scene_graph_node(&graphNode->fnNode.node);
 
     gGeoViews[0] = &graphNode->fnNode.node;
+#ifndef TARGET_N64
+    sGeoLayoutUncacheable = TRUE;
+#endif
 
     gGeoLayoutCommand += 0x14 << CMD_SIZE_SHIFT;
 }
@@ -716,6 +887,9 @@ void geo_layout_cmd_copy_view(void) {
     struct GraphNode *node = NULL;
     s16 index = cur_geo_cmd_s16(0x02);
 
+#ifndef TARGET_N64
+    sGeoLayoutUncacheable = TRUE;
+#endif
     if (index >= 0) {
         node = gGeoViews[index];
 
@@ -768,6 +942,22 @@ void geo_layout_cmd_node_culling_radius(void) {
 }
 
 struct GraphNode *process_geo_layout(struct AllocOnlyPool *pool, void *segptr) {
+#ifndef TARGET_N64
+    struct GeoLayoutTemplate *entry = geo_layout_cache_find(segmented_to_virtual(segptr));
+    u8 *start = pool->freePtr;
+
+    if (entry != NULL && entry->data != NULL) {
+        struct GraphNode *root = geo_layout_cache_instantiate(pool, entry);
+
+        if (root != NULL) {
+            gCurRootGraphNode = root;
+            gGeoNumViews = 0;
+            gGraphNodePool = pool;
+            return root;
+        }
+    }
+    sGeoLayoutUncacheable = FALSE;
+#endif
     // set by register_scene_graph_node when gCurGraphNodeIndex is 0
     // and gCurRootGraphNode is NULL
     gCurRootGraphNode = NULL;
@@ -791,5 +981,10 @@ struct GraphNode *process_geo_layout(struct AllocOnlyPool *pool, void *segptr) {
         GeoLayoutJumpTable[gGeoLayoutCommand[0x00]]();
     }
 
+#ifndef TARGET_N64
+    if (entry != NULL && entry->data == NULL && !entry->uncacheable) {
+        geo_layout_cache_store(entry, start, pool->freePtr, gCurRootGraphNode);
+    }
+#endif
     return gCurRootGraphNode;
 }
@@ -83,5 +83,8 @@ void geo_layout_cmd_node_held_obj(void);
 void geo_layout_cmd_node_culling_radius(void);
 
 struct GraphNode *process_geo_layout(struct AllocOnlyPool *a0, void *segptr);
+#ifndef TARGET_N64
+void geo_layout_savestate_exclude(void (*exclude)(void *addr, u32 size));
+#endif
 
 #endif // GEO_LAYOUT_H
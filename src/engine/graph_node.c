@@ -687,6 +687,20 @@ void geo_reset_object_node(struct GraphNodeObject *graphNode) {
     graphNode->node.flags &= ~GRAPH_RENDER_ACTIVE;
 }
 
+#ifndef TARGET_N64
+/**
+ * Take a free object's node out of the scene graph, so that the graph walk only visits
+ * live objects. The node is left linked to itself under gObjParentGraphNode, which makes
+ * geo_remove_child a no-op on it when the object is allocated again.
+ */
+void geo_detach_object_node(struct GraphNodeObject *graphNode) {
+    geo_remove_child(&graphNode->node);
+    graphNode->node.parent = &gObjParentGraphNode;
+    graphNode->node.prev = &graphNode->node;
+    graphNode->node.next = &graphNode->node;
+}
+#endif
+
 /**
  * Initialize an object node using the given parameters
  */
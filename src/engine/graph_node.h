@@ -413,6 +413,9 @@ void geo_call_global_function_nodes_helper(struct GraphNode *graphNode, s32 call
 void geo_call_global_function_nodes(struct GraphNode *graphNode, s32 callContext);
 
 void geo_reset_object_node(struct GraphNodeObject *graphNode);
+#ifndef TARGET_N64
+void geo_detach_object_node(struct GraphNodeObject *graphNode);
+#endif
 void geo_obj_init(struct GraphNodeObject *graphNode, void *sharedChild, Vec3f pos, Vec3s angle);
 void geo_obj_init_spawninfo(struct GraphNodeObject *graphNode, struct SpawnInfo *spawn);
 void geo_obj_init_animation(struct GraphNodeObject *graphNode, struct Animation **animPtrAddr);
@@ -336,6 +336,9 @@ static void level_cmd_alloc_level_pool(void) {
 static void level_cmd_free_level_pool(void) {
     s32 i;
 
+#ifdef MEMORY_STATS
+    memory_stats_level_pool(sLevelPool->usedSpace);
+#endif
     alloc_only_pool_resize(sLevelPool, sLevelPool->usedSpace);
     sLevelPool = NULL;
 
@@ -613,12 +616,18 @@ static void level_cmd_set_terrain_data(void) {
 #else
         Collision *data;
         u32 size;
+        s32 hasEnvironment;
 
-        // The game modifies the terrain data and must be reset upon level reload.
+        // The game modifies the environment regions in the terrain data, so terrain that has
+        // them must be copied to be reset upon level reload. Other terrain is used in place.
         data = segmented_to_virtual(CMD_GET(void *, 4));
-        size = get_area_terrain_size(data) * sizeof(Collision);
-        gAreas[sCurrAreaIndex].terrainData = alloc_only_pool_alloc(sLevelPool, size);
-        memcpy(gAreas[sCurrAreaIndex].terrainData, data, size);
+        size = get_area_terrain_size(data, &hasEnvironment) * sizeof(Collision);
+        if (hasEnvironment) {
+            gAreas[sCurrAreaIndex].terrainData = alloc_only_pool_alloc(sLevelPool, size);
+            memcpy(gAreas[sCurrAreaIndex].terrainData, data, size);
+        } else {
+            gAreas[sCurrAreaIndex].terrainData = data;
+        }
 #endif
     }
     sCurrentCmd = CMD_NEXT;
@@ -7,6 +7,15 @@
 
 #include "trig_tables.inc.c"
 
+#ifdef MATH_UTIL_SIMD
+#include <string.h>
+#endif
+#if defined(MATH_UTIL_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(MATH_UTIL_SIMD)
+#include <arm_neon.h>
+#endif
+
 // Variables for a spline curve animation (used for the flight path in the grand star cutscene)
 Vec4s *gSplineKeyframe;
 float gSplineKeyframeFraction;
@@ -17,6 +26,43 @@ int gSplineState;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wreturn-local-addr"
 
+#ifdef MATH_UTIL_SIMD
+// The few vector operations the SIMD matrix functions need. They only use separate
+// multiplies and adds, in the order of the scalar code, so they round the same way
+// wherever the compiler doesn't contract the scalar code into fused multiply-adds.
+#ifdef __SSE2__
+typedef __m128 MathVec;
+
+#define vec_load(src) _mm_loadu_ps(src)
+#define vec_store(dest, v) _mm_storeu_ps(dest, v)
+#define vec_set(x, y, z, w) _mm_setr_ps(x, y, z, w)
+#define vec_splat(x) _mm_set1_ps(x)
+#define vec_lane(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+#define vec_add(a, b) _mm_add_ps(a, b)
+#define vec_mul(a, b) _mm_mul_ps(a, b)
+
+// Replaces the w component
+static inline MathVec vec_set_w(MathVec v, f32 w) {
+    return _mm_or_ps(_mm_and_ps(v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0))), _mm_setr_ps(0, 0, 0, w));
+}
+#else
+typedef float32x4_t MathVec;
+
+#define vec_load(src) vld1q_f32(src)
+#define vec_store(dest, v) vst1q_f32(dest, v)
+#define vec_splat(x) vdupq_n_f32(x)
+#define vec_lane(v, i) vdupq_n_f32(vgetq_lane_f32(v, i))
+#define vec_add(a, b) vaddq_f32(a, b)
+#define vec_mul(a, b) vmulq_f32(a, b)
+#define vec_set_w(v, w) vsetq_lane_f32(w, v, 3)
+
+static inline MathVec vec_set(f32 x, f32 y, f32 z, f32 w) {
+    f32 v[4] = { x, y, z, w };
+    return vld1q_f32(v);
+}
+#endif
+#endif
+
 /// Copy vector 'src' to 'dest'
 void *vec3f_copy(Vec3f dest, Vec3f src) {
     dest[0] = src[0];
@@ -331,7 +377,11 @@ void mtxf_rotate_xyz_and_translate(Mat4 dest, Vec3f b, Vec3s c) {
  * 'position' is the position of the object in the world
  * 'angle' rotates the object while still facing the camera.
  */
+#ifdef MATH_UTIL_SIMD
+void mtxf_billboard_scalar(Mat4 dest, Mat4 mtx, Vec3f position, s16 angle) {
+#else
 void mtxf_billboard(Mat4 dest, Mat4 mtx, Vec3f position, s16 angle) {
+#endif
     dest[0][0] = coss(angle);
     dest[0][1] = sins(angle);
     dest[0][2] = 0;
@@ -356,6 +406,25 @@ void mtxf_billboard(Mat4 dest, Mat4 mtx, Vec3f position, s16 angle) {
     dest[3][3] = 1;
 }
 
+#ifdef MATH_UTIL_SIMD
+void mtxf_billboard(Mat4 dest, Mat4 mtx, Vec3f position, s16 angle) {
+    f32 cosAngle = coss(angle);
+    f32 sinAngle = sins(angle);
+    MathVec translation;
+
+    vec_store(dest[0], vec_set(cosAngle, sinAngle, 0, 0));
+    vec_store(dest[1], vec_set(-sinAngle, cosAngle, 0, 0));
+    vec_store(dest[2], vec_set(0, 0, 1, 0));
+
+    // Read after the other rows are written, like the scalar version, in case dest is mtx
+    translation = vec_add(vec_add(vec_add(vec_mul(vec_load(mtx[0]), vec_splat(position[0])),
+                                          vec_mul(vec_load(mtx[1]), vec_splat(position[1]))),
+                                  vec_mul(vec_load(mtx[2]), vec_splat(position[2]))),
+                          vec_load(mtx[3]));
+    vec_store(dest[3], vec_set_w(translation, 1));
+}
+#endif
+
 /**
  * Set 'dest' to a transformation matrix that aligns an object with the terrain
  * based on the normal. Used for enemies.
@@ -480,7 +549,11 @@ void mtxf_align_terrain_triangle(Mat4 mtx, Vec3f pos, s16 yaw, f32 radius) {
  * The resulting matrix represents first applying transformation b and
  * then a.
  */
+#ifdef MATH_UTIL_SIMD
+void mtxf_mul_scalar(Mat4 dest, Mat4 a, Mat4 b) {
+#else
 void mtxf_mul(Mat4 dest, Mat4 a, Mat4 b) {
+#endif
     Mat4 temp;
     register f32 entry0;
     register f32 entry1;
@@ -524,6 +597,30 @@ void mtxf_mul(Mat4 dest, Mat4 a, Mat4 b) {
     mtxf_copy(dest, temp);
 }
 
+#ifdef MATH_UTIL_SIMD
+// Every row of b is loaded before dest is written, so dest may be a or b
+void mtxf_mul(Mat4 dest, Mat4 a, Mat4 b) {
+    MathVec b0 = vec_load(b[0]);
+    MathVec b1 = vec_load(b[1]);
+    MathVec b2 = vec_load(b[2]);
+    MathVec b3 = vec_load(b[3]);
+    MathVec row;
+    s32 i;
+
+    for (i = 0; i < 3; i++) {
+        row = vec_load(a[i]);
+        row = vec_add(vec_add(vec_mul(vec_lane(row, 0), b0), vec_mul(vec_lane(row, 1), b1)),
+                      vec_mul(vec_lane(row, 2), b2));
+        vec_store(dest[i], vec_set_w(row, 0));
+    }
+    row = vec_load(a[3]);
+    row = vec_add(vec_add(vec_add(vec_mul(vec_lane(row, 0), b0), vec_mul(vec_lane(row, 1), b1)),
+                          vec_mul(vec_lane(row, 2), b2)),
+                  b3);
+    vec_store(dest[3], vec_set_w(row, 1));
+}
+#endif
+
 /**
  * Set matrix 'dest' to 'mtx' scaled by vector s
  */
@@ -543,7 +640,11 @@ void mtxf_scale_vec3f(Mat4 dest, Mat4 mtx, Vec3f s) {
  * to the point. Note that the bottom row is assumed to be [0, 0, 0, 1], which is
  * true for transformation matrices if the translation has a w component of 1.
  */
+#ifdef MATH_UTIL_SIMD
+void mtxf_mul_vec3s_scalar(Mat4 mtx, Vec3s b) {
+#else
 void mtxf_mul_vec3s(Mat4 mtx, Vec3s b) {
+#endif
     register f32 x = b[0];
     register f32 y = b[1];
     register f32 z = b[2];
@@ -553,6 +654,21 @@ void mtxf_mul_vec3s(Mat4 mtx, Vec3s b) {
     b[2] = x * mtx[0][2] + y * mtx[1][2] + z * mtx[2][2] + mtx[3][2];
 }
 
+#ifdef MATH_UTIL_SIMD
+void mtxf_mul_vec3s(Mat4 mtx, Vec3s b) {
+    f32 result[4];
+
+    vec_store(result, vec_add(vec_add(vec_add(vec_mul(vec_splat(b[0]), vec_load(mtx[0])),
+                                              vec_mul(vec_splat(b[1]), vec_load(mtx[1]))),
+                                      vec_mul(vec_splat(b[2]), vec_load(mtx[2]))),
+                              vec_load(mtx[3])));
+    // Converted one by one, so out of range values wrap the same way as in the scalar version
+    b[0] = result[0];
+    b[1] = result[1];
+    b[2] = result[2];
+}
+#endif
+
 /**
  * Convert float matrix 'src' to fixed point matrix 'dest'.
  * The float matrix may not contain entries larger than 65536 or the console
@@ -562,7 +678,11 @@ void mtxf_mul_vec3s(Mat4 mtx, Vec3s b) {
  * exception. On Wii and Wii U Virtual Console the value will simply be clamped
  * and no crashes occur.
  */
+#ifdef MATH_UTIL_SIMD
+void mtxf_to_mtx_scalar(Mtx *dest, Mat4 src) {
+#else
 void mtxf_to_mtx(Mtx *dest, Mat4 src) {
+#endif
 #ifdef AVOID_UB
     // Avoid type-casting which is technically UB by calling the equivalent
     // guMtxF2L function. This helps little-endian systems, as well.
@@ -582,6 +702,47 @@ void mtxf_to_mtx(Mtx *dest, Mat4 src) {
 #endif
 }
 
+#ifdef MATH_UTIL_SIMD
+/**
+ * Same output as guMtxF2L, bit for bit, since the display list consumes it directly.
+ * Float matrices are copied as is, without the call. Fixed point ones get the truncated 16.16 value of
+ * every entry, with the integer parts in the first half of the matrix and the
+ * fractions in the second, each pair of halves swapped within its 32-bit word.
+ */
+void mtxf_to_mtx(Mtx *dest, Mat4 src) {
+#ifdef GBI_FLOATS
+    memcpy(dest, src, sizeof(Mtx));
+#elif defined(__SSE2__)
+    __m128 scale = _mm_set1_ps(65536.0f);
+    s32 i;
+
+    for (i = 0; i < 4; i += 2) {
+        __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src[i]), scale));
+        __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src[i + 1]), scale));
+
+        a = _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i *) dest->m[i / 2],
+                         _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16)));
+        _mm_storeu_si128((__m128i *) dest->m[2 + i / 2],
+                         _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                         _mm_srai_epi32(_mm_slli_epi32(b, 16), 16)));
+    }
+#else
+    float32x4_t scale = vdupq_n_f32(65536.0f);
+    s32 i;
+
+    for (i = 0; i < 4; i += 2) {
+        int32x4_t a = vrev64q_s32(vcvtq_s32_f32(vmulq_f32(vld1q_f32(src[i]), scale)));
+        int32x4_t b = vrev64q_s32(vcvtq_s32_f32(vmulq_f32(vld1q_f32(src[i + 1]), scale)));
+
+        vst1q_s16((s16 *) dest->m[i / 2], vcombine_s16(vshrn_n_s32(a, 16), vshrn_n_s32(b, 16)));
+        vst1q_s16((s16 *) dest->m[2 + i / 2], vcombine_s16(vmovn_s32(a), vmovn_s32(b)));
+    }
+#endif
+}
+#endif
+
 /**
  * Set 'mtx' to a transformation matrix that rotates around the z axis.
  */
@@ -32,6 +32,13 @@ extern f32 gCosineTable[];
 
 #define sqr(x) ((x) * (x))
 
+// SSE2/NEON versions of the matrix functions the scene graph calls the most, outside of
+// N64 builds. The scalar versions keep a _scalar suffix so sm64_math_util_bench can
+// compare the two.
+#if !defined(TARGET_N64) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define MATH_UTIL_SIMD
+#endif
+
 void *vec3f_copy(Vec3f dest, Vec3f src);
 void *vec3f_set(Vec3f dest, f32 x, f32 y, f32 z);
 void *vec3f_add(Vec3f dest, Vec3f a);
@@ -71,4 +78,11 @@ void spline_get_weights(Vec4f result, f32 t, UNUSED s32 c);
 void anim_spline_init(Vec4s *keyFrames);
 s32 anim_spline_poll(Vec3f result);
 
+#ifdef MATH_UTIL_SIMD
+void mtxf_billboard_scalar(Mat4 dest, Mat4 mtx, Vec3f position, s16 angle);
+void mtxf_mul_scalar(Mat4 dest, Mat4 a, Mat4 b);
+void mtxf_mul_vec3s_scalar(Mat4 mtx, Vec3s b);
+void mtxf_to_mtx_scalar(Mtx *dest, Mat4 src);
+#endif
+
 #endif // MATH_UTIL_H
@@ -535,8 +535,10 @@ void alloc_surface_pools(void) {
 #ifdef NO_SEGMENTED_MEMORY
 /**
  * Get the size of the terrain data, to get the correct size when copying later.
+ * Also reports whether the data has environment regions, the only part of the
+ * terrain data that the game writes to (for example WDW's water level).
  */
-u32 get_area_terrain_size(s16 *data) {
+u32 get_area_terrain_size(s16 *data, s32 *hasEnvironment) {
     s16 *startPos = data;
     s32 end = FALSE;
     s16 terrainLoadType;
@@ -545,6 +547,7 @@ u32 get_area_terrain_size(s16 *data) {
     s32 numSurfaces;
     s16 hasForce;
 
+    *hasEnvironment = FALSE;
     while (!end) {
         terrainLoadType = *data++;
 
@@ -561,6 +564,7 @@ u32 get_area_terrain_size(s16 *data) {
             case TERRAIN_LOAD_ENVIRONMENT:
                 numRegions = *data++;
                 data += 6 * numRegions;
+                *hasEnvironment = TRUE;
                 break;
 
             case TERRAIN_LOAD_CONTINUE:
@@ -31,7 +31,7 @@ extern s16 sSurfacePoolSize;
 
 void alloc_surface_pools(void);
 #ifdef NO_SEGMENTED_MEMORY
-u32 get_area_terrain_size(s16 *data);
+u32 get_area_terrain_size(s16 *data, s32 *hasEnvironment);
 #endif
 void load_area_terrain(s16 index, s16 *data, s8 *surfaceRooms, s16 *macroObjects);
 void clear_dynamic_surfaces(void);
@@ -24,6 +24,9 @@ s16 gEnvFxBubbleConfig[10];
 static Gfx *sGfxCursor; // points to end of display list for bubble particles
 static s32 sBubbleParticleCount;
 static s32 sBubbleParticleMaxCount;
+#ifndef TARGET_N64
+static void *sBubbleTexture; // texture loaded by the last envfx_set_bubble_texture call
+#endif
 
 UNUSED s32 D_80330690 = 0;
 UNUSED s32 D_80330694 = 0;
@@ -491,6 +494,16 @@ void envfx_set_bubble_texture(s32 mode, s16 index) {
             break;
     }
 
+#ifndef TARGET_N64
+    // Consecutive particles often share a texture (the whirlpool and jet stream
+    // bubbles always do), so it is only loaded again when it changes. That keeps
+    // them in one batch of triangles for the renderer.
+    if (*(imageArr + frame) == sBubbleTexture) {
+        return;
+    }
+    sBubbleTexture = *(imageArr + frame);
+#endif
+
     gDPSetTextureImage(sGfxCursor++, G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, *(imageArr + frame));
     gSPDisplayList(sGfxCursor++, &tiny_bubble_dl_0B006D68);
 }
@@ -508,6 +521,9 @@ Gfx *envfx_update_bubble_particles(s32 mode, UNUSED Vec3s marioPos, Vec3s camFro
     Vec3s vertex3;
 
     Gfx *gfxStart;
+#ifndef TARGET_N64
+    Vtx *vertBuf;
+#endif
 
     gfxStart = alloc_display_list(((sBubbleParticleMaxCount / 5) * 10 + sBubbleParticleMaxCount + 3)
                                   * sizeof(Gfx));
@@ -521,12 +537,25 @@ Gfx *envfx_update_bubble_particles(s32 mode, UNUSED Vec3s marioPos, Vec3s camFro
     envfx_bubbles_update_switch(mode, camTo, vertex1, vertex2, vertex3);
     rotate_triangle_vertices(vertex1, vertex2, vertex3, pitch, yaw);
 
+#ifndef TARGET_N64
+    vertBuf = envfx_alloc_particle_vertices(sBubbleParticleMaxCount, vertex1, vertex2, vertex3,
+                                            (Vtx *) gBubbleTempVtx);
+    if (vertBuf == NULL) {
+        return NULL;
+    }
+    sBubbleTexture = NULL;
+#endif
+
     gSPDisplayList(sGfxCursor++, &tiny_bubble_dl_0B006D38);
 
     for (i = 0; i < sBubbleParticleMaxCount; i += 5) {
         gDPPipeSync(sGfxCursor++);
         envfx_set_bubble_texture(mode, i);
+#ifndef TARGET_N64
+        gSPVertex(sGfxCursor++, VIRTUAL_TO_PHYSICAL(vertBuf + i * 3), 15, 0);
+#else
         append_bubble_vertex_buffer(sGfxCursor++, i, vertex1, vertex2, vertex3, (Vtx *) gBubbleTempVtx);
+#endif
         gSP1Triangle(sGfxCursor++, 0, 1, 2, 0);
         gSP1Triangle(sGfxCursor++, 3, 4, 5, 0);
         gSP1Triangle(sGfxCursor++, 6, 7, 8, 0);
@@ -335,6 +335,48 @@ void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 p
     vertex3[2] = v3[0] * sinMYaw + v3[1] * (-sinPitch * cosMYaw) + v3[2] * (cosPitch * cosMYaw);
 }
 
+#ifndef TARGET_N64
+/**
+ * Allocate the vertices of all 'count' particles at once, rounded up to the
+ * 5 particles that are drawn per vertex load, and place the rotated triangle
+ * given by the 3 input vertices at every particle's position. Returns NULL if
+ * the display list pool is out of space.
+ * This replaces an allocation per 5 particles, see append_snowflake_vertex_buffer
+ * and append_bubble_vertex_buffer.
+ */
+Vtx *envfx_alloc_particle_vertices(s32 count, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3,
+                                   Vtx *template) {
+    s32 i;
+    s32 numVertices = (count + 4) / 5 * 15;
+    Vtx *vertBuf = (Vtx *) alloc_display_list(numVertices * sizeof(Vtx));
+    Vtx *p = vertBuf;
+    struct EnvFxParticle *particle = gEnvFxBuffer;
+
+    if (vertBuf == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < numVertices; i += 3, p += 3, particle++) {
+        p[0] = template[0];
+        p[0].v.ob[0] = particle->xPos + vertex1[0];
+        p[0].v.ob[1] = particle->yPos + vertex1[1];
+        p[0].v.ob[2] = particle->zPos + vertex1[2];
+
+        p[1] = template[1];
+        p[1].v.ob[0] = particle->xPos + vertex2[0];
+        p[1].v.ob[1] = particle->yPos + vertex2[1];
+        p[1].v.ob[2] = particle->zPos + vertex2[2];
+
+        p[2] = template[2];
+        p[2].v.ob[0] = particle->xPos + vertex3[0];
+        p[2].v.ob[1] = particle->yPos + vertex3[1];
+        p[2].v.ob[2] = particle->zPos + vertex3[2];
+    }
+
+    return vertBuf;
+}
+#endif
+
 /**
  * Append 15 vertices to 'gfx', which is enough for 5 snowflakes starting at
  * 'index' in the buffer. The 3 input vertices represent the rotated triangle
@@ -409,6 +451,9 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
     struct SnowFlakeVertex vertex1, vertex2, vertex3;
     Gfx *gfxStart;
     Gfx *gfx;
+#ifndef TARGET_N64
+    Vtx *vertBuf;
+#endif
 
     vertex1 = gSnowFlakeVertex1;
     vertex2 = gSnowFlakeVertex2;
@@ -464,6 +509,14 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
 
     rotate_triangle_vertices((s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3, pitch, yaw);
 
+#ifndef TARGET_N64
+    vertBuf = envfx_alloc_particle_vertices(gSnowParticleCount, (s16 *) &vertex1, (s16 *) &vertex2,
+                                            (s16 *) &vertex3, gSnowTempVtx);
+    if (vertBuf == NULL) {
+        return NULL;
+    }
+#endif
+
     if (snowMode == ENVFX_SNOW_NORMAL || snowMode == ENVFX_SNOW_BLIZZARD) {
         gSPDisplayList(gfx++, &tiny_bubble_dl_0B006A50); // snowflake with gray edge
     } else if (snowMode == ENVFX_SNOW_WATER) {
@@ -471,7 +524,11 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
     }
 
     for (i = 0; i < gSnowParticleCount; i += 5) {
+#ifndef TARGET_N64
+        gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL(vertBuf + i * 3), 15, 0);
+#else
         append_snowflake_vertex_buffer(gfx++, i, (s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3);
+#endif
 
         gSP1Triangle(gfx++, 0, 1, 2, 0);
         gSP1Triangle(gfx++, 3, 4, 5, 0);
@@ -38,5 +38,9 @@ extern s16 gSnowParticleCount;
 Gfx *envfx_update_particles(s32 snowMode, Vec3s marioPos, Vec3s camTo, Vec3s camFrom);
 void orbit_from_positions(Vec3s from, Vec3s to, s16 *radius, s16 *pitch, s16 *yaw);
 void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 pitch, s16 yaw);
+#ifndef TARGET_N64
+Vtx *envfx_alloc_particle_vertices(s32 count, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3,
+                                   Vtx *template);
+#endif
 
 #endif // ENVFX_SNOW_H
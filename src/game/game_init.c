@@ -222,6 +222,12 @@ void make_viewport_clip_rect(Vp *viewport) {
 void create_task_structure(void) {
     s32 entries = gDisplayListHead - gGfxPool->buffer;
 
+#ifndef TARGET_N64
+    // A list that went on in overflow chunks is counted as the whole pool
+    if (entries < 0 || entries > GFX_POOL_SIZE) {
+        entries = GFX_POOL_SIZE;
+    }
+#endif
     gGfxSPTask->msgqueue = &D_80339CB8;
     gGfxSPTask->msg = (OSMesg) 2;
     gGfxSPTask->task.t.type = M_GFXTASK;
@@ -264,6 +270,9 @@ void end_master_display_list(void) {
 
     gDPFullSync(gDisplayListHead++);
     gSPEndDisplayList(gDisplayListHead++);
+#ifndef TARGET_N64
+    display_list_pool_end_frame();
+#endif
 
     create_task_structure();
 }
@@ -302,6 +311,9 @@ void rendering_init(void) {
     gGfxSPTask = &gGfxPool->spTask;
     gDisplayListHead = gGfxPool->buffer;
     gGfxPoolEnd = (u8 *) (gGfxPool->buffer + GFX_POOL_SIZE);
+#ifndef TARGET_N64
+    display_list_pool_init();
+#endif
     init_render_image();
     clear_frame_buffer(0);
     end_master_display_list();
@@ -317,6 +329,9 @@ void config_gfx_pool(void) {
     gGfxSPTask = &gGfxPool->spTask;
     gDisplayListHead = gGfxPool->buffer;
     gGfxPoolEnd = (u8 *) (gGfxPool->buffer + GFX_POOL_SIZE);
+#ifndef TARGET_N64
+    display_list_pool_init();
+#endif
 }
 
 /** Handles vsync. */
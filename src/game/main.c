@@ -141,6 +141,11 @@ void alloc_pool(void) {
     void *start = (void *) SEG_POOL_START;
     void *end = (void *) SEG_POOL_END;
 
+#ifdef MIO0_CACHE_SIZE
+    // Carve the decompressed segment cache off the top, so it outlives the pool's contents
+    end = (u8 *) end - MIO0_CACHE_SIZE;
+    mio0_cache_init(end, MIO0_CACHE_SIZE);
+#endif
     main_pool_init(start, end);
     gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
 }
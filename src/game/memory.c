@@ -1,5 +1,6 @@
 #include <PR/ultratypes.h>
 #ifndef TARGET_N64
+#include <stdlib.h>
 #include <string.h>
 #endif
 
@@ -14,6 +15,10 @@
 #include "memory.h"
 #include "segment_symbols.h"
 #include "segments.h"
+#ifdef MEMORY_STATS
+#include "area.h"
+#include "level_table.h"
+#endif
 
 // round up to the next multiple
 #define ALIGN4(val) (((val) + 0x3) & ~0x3)
@@ -32,10 +37,28 @@ struct MainPoolBlock {
     struct MainPoolBlock *next;
 };
 
+#ifndef TARGET_N64
+// Freed blocks up to this size (header included) go to a free list per size class instead of
+// being merged into the main free list, so that allocating them again is O(1). At most a
+// quarter of the pool is kept in those lists, to bound the fragmentation they cause.
+#define MEM_POOL_QUICK_MAX 512
+#define MEM_POOL_QUICK_CLASSES (MEM_POOL_QUICK_MAX / 8)
+#define MEM_POOL_QUICK_CLASS(size) ((size) / 8 - 1)
+#endif
+
 struct MemoryPool {
     u32 totalSpace;
     struct MemoryBlock *firstBlock;
     struct MemoryBlock *freeList;
+#ifndef TARGET_N64
+    struct MemoryBlock *quickLists[MEM_POOL_QUICK_CLASSES];
+    u32 usedSpace;
+    u32 quickSpace; // Free space held in quickLists
+    u32 quickAllocs;
+    u32 listAllocs;
+    u32 flushes;
+    u32 failedAllocs;
+#endif
 };
 
 struct MemoryBlock {
@@ -67,6 +90,138 @@ struct MainPoolBlock *sPoolListHeadR;
 
 static struct MainPoolState *gMainPoolState = NULL;
 
+#ifdef MEMORY_STATS
+struct MemoryStats gMemoryStats;
+struct MemoryStats gLevelMemoryStats[LEVEL_COUNT];
+struct MemoryStatsSite gMemoryStatsSites[MEMORY_STATS_MAX_SITES];
+s32 gMemoryStatsSiteCount;
+const char *gMemoryStatsSite; // Call site of the allocation in progress, set by the memory.h macros
+
+// The allocation-only pool at the top of the left side, if it's still open. Pools like
+// sLevelPool take all the remaining space, so only their used part counts as used.
+static struct AllocOnlyPool *sOpenAllocOnlyPool;
+static const char *sOpenAllocOnlyPoolSite;
+
+static struct MemoryStatsSite *memory_stats_find_site(const char *site, u32 side) {
+    s32 i;
+
+    for (i = 0; i < gMemoryStatsSiteCount; i++) {
+        if (gMemoryStatsSites[i].site == site && gMemoryStatsSites[i].side == side) {
+            return &gMemoryStatsSites[i];
+        }
+    }
+    if (gMemoryStatsSiteCount == MEMORY_STATS_MAX_SITES) {
+        return NULL;
+    }
+    gMemoryStatsSites[i].site = site;
+    gMemoryStatsSites[i].side = side;
+    return &gMemoryStatsSites[gMemoryStatsSiteCount++];
+}
+
+static void memory_stats_peaks(struct MemoryStats *stats, u32 left, u32 right, const char *site) {
+    if (left > stats->leftPeak) {
+        stats->leftPeak = left;
+        stats->leftPeakSite = site;
+    }
+    if (right > stats->rightPeak) {
+        stats->rightPeak = right;
+        stats->rightPeakSite = site;
+    }
+}
+
+static struct MemoryStats *memory_stats_level(void) {
+    return gCurrLevelNum >= 0 && gCurrLevelNum < LEVEL_COUNT ? &gLevelMemoryStats[gCurrLevelNum] : NULL;
+}
+
+/**
+ * Record the pool usage after an allocation of size bytes from side, made by site
+ * (NULL for allocations inside allocation-only pools).
+ */
+static void memory_stats_update(const char *site, u32 side, u32 size) {
+    struct MemoryStats *level = memory_stats_level();
+    struct MemoryStatsSite *entry;
+    u32 left = (u8 *) sPoolListHeadL - sPoolStart;
+    u32 right = sPoolEnd - (u8 *) sPoolListHeadR;
+
+    if (sOpenAllocOnlyPool != NULL) {
+        left -= sOpenAllocOnlyPool->totalSpace - sOpenAllocOnlyPool->usedSpace;
+    }
+    memory_stats_peaks(&gMemoryStats, left, right, site != NULL ? site : sOpenAllocOnlyPoolSite);
+    if (level != NULL) {
+        memory_stats_peaks(level, left, right, site != NULL ? site : sOpenAllocOnlyPoolSite);
+    }
+
+    if (site != NULL && (entry = memory_stats_find_site(site, side)) != NULL) {
+        u32 sideUsed = side == MEMORY_POOL_LEFT ? left : right;
+
+        entry->calls++;
+        if (size > entry->largest) {
+            entry->largest = size;
+        }
+        if (sideUsed > entry->sidePeak) {
+            entry->sidePeak = sideUsed;
+        }
+    }
+}
+
+static void memory_stats_effects(struct MemoryPool *pool) {
+    struct MemoryStats *level = memory_stats_level();
+    u32 used = pool->usedSpace;
+
+    if (used > gMemoryStats.effectsPeak) {
+        gMemoryStats.effectsPeak = used;
+    }
+    if (level != NULL && used > level->effectsPeak) {
+        level->effectsPeak = used;
+    }
+}
+
+void memory_stats_level_pool(u32 usedSpace) {
+    struct MemoryStats *level = memory_stats_level();
+
+    if (usedSpace > gMemoryStats.levelPoolPeak) {
+        gMemoryStats.levelPoolPeak = usedSpace;
+    }
+    if (level != NULL && usedSpace > level->levelPoolPeak) {
+        level->levelPoolPeak = usedSpace;
+    }
+}
+
+void memory_stats_print(FILE *file) {
+    s32 i;
+
+    fprintf(file, "main pool: %u bytes, peak %u left (%s) + %u right (%s), %u failed allocations\n",
+            (u32) (sPoolEnd - sPoolStart), gMemoryStats.leftPeak, gMemoryStats.leftPeakSite,
+            gMemoryStats.rightPeak, gMemoryStats.rightPeakSite, gMemoryStats.failedAllocs);
+    fprintf(file, "effects pool peak %u, level pool peak %u\n", gMemoryStats.effectsPeak,
+            gMemoryStats.levelPoolPeak);
+    fprintf(file,
+            "display list pool: %u bytes, peak %u in one frame, %u frames overflowed %u times into %u "
+            "bytes of chunks, %u list nodes overflowed, %u failed allocations\n",
+            gDisplayListPoolStats.poolSize, gDisplayListPoolStats.peakUsed,
+            gDisplayListPoolStats.overflowFrames, gDisplayListPoolStats.overflows,
+            gDisplayListPoolStats.chunkSpace, gDisplayListPoolStats.listNodeOverflows,
+            gDisplayListPoolStats.failedAllocs);
+    fprintf(file, "%5s %10s %10s %10s %10s %10s %8s\n", "level", "left", "right", "effects", "levelpool",
+            "displist", "failed");
+    for (i = 0; i < LEVEL_COUNT; i++) {
+        struct MemoryStats *level = &gLevelMemoryStats[i];
+
+        if (level->leftPeak != 0 || level->rightPeak != 0) {
+            fprintf(file, "%5d %10u %10u %10u %10u %10u %8u\n", i, level->leftPeak, level->rightPeak,
+                    level->effectsPeak, level->levelPoolPeak, level->displayListPeak, level->failedAllocs);
+        }
+    }
+    fprintf(file, "%-48s %5s %8s %10s %10s\n", "call site", "side", "calls", "largest", "side peak");
+    for (i = 0; i < gMemoryStatsSiteCount; i++) {
+        struct MemoryStatsSite *site = &gMemoryStatsSites[i];
+
+        fprintf(file, "%-48s %5s %8u %10u %10u\n", site->site,
+                site->side == MEMORY_POOL_LEFT ? "left" : "right", site->calls, site->largest, site->sidePeak);
+    }
+}
+#endif
+
 uintptr_t set_segment_base_addr(s32 segment, void *addr) {
     sSegmentTable[segment] = (uintptr_t) addr & 0x1FFFFFFF;
     return sSegmentTable[segment];
@@ -135,6 +290,12 @@ void main_pool_init(void *start, void *end) {
 void *main_pool_alloc(u32 size, u32 side) {
     struct MainPoolBlock *newListHead;
     void *addr = NULL;
+#ifdef MEMORY_STATS
+    const char *site = gMemoryStatsSite != NULL ? gMemoryStatsSite : __FILE__;
+    u32 requested = size;
+
+    gMemoryStatsSite = NULL;
+#endif
 
     size = ALIGN16(size) + 16;
     if (size != 0 && sPoolFreeSpace >= size) {
@@ -155,6 +316,22 @@ void *main_pool_alloc(u32 size, u32 side) {
             addr = (u8 *) sPoolListHeadR + 16;
         }
     }
+#ifdef MEMORY_STATS
+    if (addr == NULL) {
+        struct MemoryStats *level = memory_stats_level();
+
+        gMemoryStats.failedAllocs++;
+        if (level != NULL) {
+            level->failedAllocs++;
+        }
+        fprintf(stderr, "main_pool_alloc: %u bytes for %s failed, %u free\n", requested, site, sPoolFreeSpace);
+    } else {
+        if (side == MEMORY_POOL_LEFT && addr != sOpenAllocOnlyPool) {
+            sOpenAllocOnlyPool = NULL;
+        }
+        memory_stats_update(site, side, requested);
+    }
+#endif
     return addr;
 }
 
@@ -182,6 +359,11 @@ u32 main_pool_free(void *addr) {
         sPoolListHeadR->prev = NULL;
         sPoolFreeSpace += (uintptr_t) sPoolListHeadR - (uintptr_t) oldListHead;
     }
+#ifdef MEMORY_STATS
+    if ((u8 *) sOpenAllocOnlyPool >= (u8 *) sPoolListHeadL) {
+        sOpenAllocOnlyPool = NULL;
+    }
+#endif
     return sPoolFreeSpace;
 }
 
@@ -237,6 +419,11 @@ u32 main_pool_pop_state(void) {
     sPoolListHeadL = gMainPoolState->listHeadL;
     sPoolListHeadR = gMainPoolState->listHeadR;
     gMainPoolState = gMainPoolState->prev;
+#ifdef MEMORY_STATS
+    if ((u8 *) sOpenAllocOnlyPool >= (u8 *) sPoolListHeadL) {
+        sOpenAllocOnlyPool = NULL;
+    }
+#endif
     return sPoolFreeSpace;
 }
 
@@ -280,6 +467,124 @@ static void *dynamic_dma_read(u8 *srcStart, u8 *srcEnd, u32 side) {
 }
 
 #ifndef NO_SEGMENTED_MEMORY
+#ifdef MIO0_CACHE_SIZE
+#define MIO0_CACHE_ENTRIES 32
+
+/**
+ * Cache of decompressed MIO0 segments, keyed by ROM address. It lives in its
+ * own region outside of the main pool, so it survives the pool being popped
+ * on level transitions, and reloading a level only needs a copy instead of a
+ * DMA and a decompression. Least recently used segments are evicted when the
+ * budget runs out.
+ */
+struct Mio0CacheEntry {
+    u8 *srcStart; // NULL if the entry is unused
+    u8 *data;
+    u32 size;
+    u32 lastUse;
+};
+
+struct Mio0CacheStats gMio0CacheStats;
+
+static struct Mio0CacheEntry sMio0Cache[MIO0_CACHE_ENTRIES];
+static u8 *sMio0CacheStart;
+static u32 sMio0CacheUseCounter;
+
+void mio0_cache_init(void *start, u32 size) {
+    bzero(sMio0Cache, sizeof(sMio0Cache));
+    bzero(&gMio0CacheStats, sizeof(gMio0CacheStats));
+    sMio0CacheStart = (u8 *) ALIGN16((uintptr_t) start);
+    gMio0CacheStats.totalSpace = size - (sMio0CacheStart - (u8 *) start);
+}
+
+static struct Mio0CacheEntry *mio0_cache_find(u8 *srcStart) {
+    s32 i;
+
+    for (i = 0; i < MIO0_CACHE_ENTRIES; i++) {
+        if (sMio0Cache[i].srcStart == srcStart) {
+            sMio0Cache[i].lastUse = ++sMio0CacheUseCounter;
+            gMio0CacheStats.hits++;
+            return &sMio0Cache[i];
+        }
+    }
+    gMio0CacheStats.misses++;
+    return NULL;
+}
+
+static void mio0_cache_evict_lru(void) {
+    struct Mio0CacheEntry *lru = NULL;
+    s32 i;
+
+    for (i = 0; i < MIO0_CACHE_ENTRIES; i++) {
+        if (sMio0Cache[i].srcStart != NULL && (lru == NULL || sMio0Cache[i].lastUse < lru->lastUse)) {
+            lru = &sMio0Cache[i];
+        }
+    }
+    if (lru != NULL) {
+        gMio0CacheStats.usedSpace -= ALIGN16(lru->size);
+        gMio0CacheStats.numEntries--;
+        gMio0CacheStats.evictions++;
+        lru->srcStart = NULL;
+    }
+}
+
+/**
+ * Move the cached segments down to the start of the cache, in address order,
+ * so that the free space is contiguous. Return the start of the free space.
+ */
+static u8 *mio0_cache_compact(void) {
+    struct Mio0CacheEntry *next;
+    u8 *freePtr = sMio0CacheStart;
+    s32 i;
+
+    do {
+        next = NULL;
+        for (i = 0; i < MIO0_CACHE_ENTRIES; i++) {
+            if (sMio0Cache[i].srcStart != NULL && sMio0Cache[i].data >= freePtr
+                && (next == NULL || sMio0Cache[i].data < next->data)) {
+                next = &sMio0Cache[i];
+            }
+        }
+        if (next != NULL) {
+            if (next->data != freePtr) {
+                bcopy(next->data, freePtr, next->size);
+                next->data = freePtr;
+            }
+            freePtr += ALIGN16(next->size);
+        }
+    } while (next != NULL);
+    return freePtr;
+}
+
+static void mio0_cache_insert(u8 *srcStart, void *data, u32 size) {
+    struct Mio0CacheEntry *entry = NULL;
+    u32 alignedSize = ALIGN16(size);
+    s32 i;
+
+    if (sMio0CacheStart == NULL || alignedSize > gMio0CacheStats.totalSpace) {
+        return;
+    }
+    while (gMio0CacheStats.usedSpace + alignedSize > gMio0CacheStats.totalSpace
+           || gMio0CacheStats.numEntries == MIO0_CACHE_ENTRIES) {
+        mio0_cache_evict_lru();
+    }
+    for (i = 0; i < MIO0_CACHE_ENTRIES; i++) {
+        if (sMio0Cache[i].srcStart == NULL) {
+            entry = &sMio0Cache[i];
+            break;
+        }
+    }
+
+    entry->data = mio0_cache_compact();
+    bcopy(data, entry->data, size);
+    entry->srcStart = srcStart;
+    entry->size = size;
+    entry->lastUse = ++sMio0CacheUseCounter;
+    gMio0CacheStats.usedSpace += alignedSize;
+    gMio0CacheStats.numEntries++;
+}
+#endif
+
 /**
  * Load data from ROM into a newly allocated block, and set the segment base
  * address to this block.
@@ -318,6 +623,47 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
     return dest;
 }
 
+#ifdef SEGMENT_LOAD_STATS
+struct SegmentLoadStats gSegmentLoadStats;
+
+static void segment_load_stats_add(OSTime start, u8 *srcStart, u8 *srcEnd) {
+    gSegmentLoadStats.loads++;
+    gSegmentLoadStats.romBytes += srcEnd - srcStart;
+    gSegmentLoadStats.time += osGetTime() - start;
+}
+#endif
+
+#ifdef UNCOMPRESSED_SEGMENTS
+/**
+ * The build stored this segment decompressed, so it only needs to be copied
+ * from ROM.
+ */
+void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    void *dest;
+#ifdef SEGMENT_LOAD_STATS
+    OSTime loadStart = osGetTime();
+#endif
+
+    dest = load_segment(segment, srcStart, srcEnd, MEMORY_POOL_LEFT);
+#ifdef SEGMENT_LOAD_STATS
+    segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
+    return dest;
+}
+
+void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
+#ifdef SEGMENT_LOAD_STATS
+    OSTime loadStart = osGetTime();
+#endif
+
+    dma_read(gDecompressionHeap, srcStart, srcEnd);
+    set_segment_base_addr(segment, gDecompressionHeap);
+#ifdef SEGMENT_LOAD_STATS
+    segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
+    return gDecompressionHeap;
+}
+#else
 /**
  * Decompress the block of ROM data from srcStart to srcEnd and return a
  * pointer to an allocated buffer holding the decompressed data. Set the
@@ -325,12 +671,33 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
  */
 void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
     void *dest = NULL;
+    u32 compSize;
+    u8 *compressed;
+    u32 *size;
+#ifdef SEGMENT_LOAD_STATS
+    OSTime loadStart = osGetTime();
+#endif
+#ifdef MIO0_CACHE_SIZE
+    struct Mio0CacheEntry *cached = mio0_cache_find(srcStart);
+
+    if (cached != NULL) {
+        dest = main_pool_alloc(cached->size, MEMORY_POOL_LEFT);
+        if (dest != NULL) {
+            bcopy(cached->data, dest, cached->size);
+            set_segment_base_addr(segment, dest);
+        }
+#ifdef SEGMENT_LOAD_STATS
+        segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
+        return dest;
+    }
+#endif
 
-    u32 compSize = ALIGN16(srcEnd - srcStart);
-    u8 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+    compSize = ALIGN16(srcEnd - srcStart);
+    compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
 
     // Decompressed size from mio0 header
-    u32 *size = (u32 *) (compressed + 4);
+    size = (u32 *) (compressed + 4);
 
     if (compressed != NULL) {
         dma_read(compressed, srcStart, srcEnd);
@@ -338,29 +705,61 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
         if (dest != NULL) {
             decompress(compressed, dest);
             set_segment_base_addr(segment, dest);
+#ifdef MIO0_CACHE_SIZE
+            mio0_cache_insert(srcStart, dest, *size);
+#endif
             main_pool_free(compressed);
         } else {
         }
     } else {
     }
+#ifdef SEGMENT_LOAD_STATS
+    segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
     return dest;
 }
 
 void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
     UNUSED void *dest = NULL;
-    u32 compSize = ALIGN16(srcEnd - srcStart);
-    u8 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
-    UNUSED u32 *pUncSize = (u32 *) (compressed + 4);
+    u32 compSize;
+    u8 *compressed;
+    UNUSED u32 *pUncSize;
+#ifdef SEGMENT_LOAD_STATS
+    OSTime loadStart = osGetTime();
+#endif
+#ifdef MIO0_CACHE_SIZE
+    struct Mio0CacheEntry *cached = mio0_cache_find(srcStart);
+
+    if (cached != NULL) {
+        bcopy(cached->data, gDecompressionHeap, cached->size);
+        set_segment_base_addr(segment, gDecompressionHeap);
+#ifdef SEGMENT_LOAD_STATS
+        segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
+        return gDecompressionHeap;
+    }
+#endif
+
+    compSize = ALIGN16(srcEnd - srcStart);
+    compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+    pUncSize = (u32 *) (compressed + 4);
 
     if (compressed != NULL) {
         dma_read(compressed, srcStart, srcEnd);
         decompress(compressed, gDecompressionHeap);
         set_segment_base_addr(segment, gDecompressionHeap);
+#ifdef MIO0_CACHE_SIZE
+        mio0_cache_insert(srcStart, gDecompressionHeap, *pUncSize);
+#endif
         main_pool_free(compressed);
     } else {
     }
+#ifdef SEGMENT_LOAD_STATS
+    segment_load_stats_add(loadStart, srcStart, srcEnd);
+#endif
     return gDecompressionHeap;
 }
+#endif
 
 void load_engine_code_segment(void) {
     void *startAddr = (void *) SEG_ENGINE;
@@ -383,6 +782,9 @@ void load_engine_code_segment(void) {
 struct AllocOnlyPool *alloc_only_pool_init(u32 size, u32 side) {
     void *addr;
     struct AllocOnlyPool *subPool = NULL;
+#ifdef MEMORY_STATS
+    const char *site = gMemoryStatsSite;
+#endif
 
     size = ALIGN4(size);
     addr = main_pool_alloc(size + sizeof(struct AllocOnlyPool), side);
@@ -392,6 +794,12 @@ struct AllocOnlyPool *alloc_only_pool_init(u32 size, u32 side) {
         subPool->usedSpace = 0;
         subPool->startPtr = (u8 *) addr + sizeof(struct AllocOnlyPool);
         subPool->freePtr = (u8 *) addr + sizeof(struct AllocOnlyPool);
+#ifdef MEMORY_STATS
+        if (side == MEMORY_POOL_LEFT) {
+            sOpenAllocOnlyPool = subPool;
+            sOpenAllocOnlyPoolSite = site;
+        }
+#endif
     }
     return subPool;
 }
@@ -408,6 +816,11 @@ void *alloc_only_pool_alloc(struct AllocOnlyPool *pool, s32 size) {
         addr = pool->freePtr;
         pool->freePtr += size;
         pool->usedSpace += size;
+#ifdef MEMORY_STATS
+        if (pool == sOpenAllocOnlyPool) {
+            memory_stats_update(NULL, MEMORY_POOL_LEFT, size);
+        }
+#endif
     }
     return addr;
 }
@@ -444,6 +857,9 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side) {
     if (addr != NULL) {
         pool = (struct MemoryPool *) addr;
 
+#ifndef TARGET_N64
+        bzero(pool, sizeof(*pool));
+#endif
         pool->totalSpace = size;
         pool->firstBlock = (struct MemoryBlock *) ((u8 *) addr + ALIGN16(sizeof(struct MemoryPool)));
         pool->freeList = (struct MemoryBlock *) ((u8 *) addr + ALIGN16(sizeof(struct MemoryPool)));
@@ -455,6 +871,7 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side) {
     return pool;
 }
 
+#ifdef TARGET_N64
 /**
  * Allocate from a memory pool. Return NULL if there is not enough space.
  */
@@ -523,15 +940,304 @@ void mem_pool_free(struct MemoryPool *pool, void *addr) {
         }
     }
 }
+#else
+/**
+ * Allocate a block of size bytes (header included) from the main free list of the pool,
+ * first fit. Return NULL if no free block is large enough.
+ */
+static void *mem_pool_list_alloc(struct MemoryPool *pool, u32 size) {
+    struct MemoryBlock *freeBlock = (struct MemoryBlock *) &pool->freeList;
+    void *addr = NULL;
+
+    while (freeBlock->next != NULL) {
+        if (freeBlock->next->size >= size) {
+            addr = (u8 *) freeBlock->next + sizeof(struct MemoryBlock);
+            if (freeBlock->next->size - size <= sizeof(struct MemoryBlock)) {
+                freeBlock->next = freeBlock->next->next;
+            } else {
+                struct MemoryBlock *newBlock = (struct MemoryBlock *) ((u8 *) freeBlock->next + size);
+                newBlock->size = freeBlock->next->size - size;
+                newBlock->next = freeBlock->next->next;
+                freeBlock->next->size = size;
+                freeBlock->next = newBlock;
+            }
+            break;
+        }
+        freeBlock = freeBlock->next;
+    }
+    return addr;
+}
+
+/**
+ * Insert a block into the main free list of the pool, which is sorted by address,
+ * merging it with its neighbors.
+ */
+static void mem_pool_list_free(struct MemoryPool *pool, struct MemoryBlock *block) {
+    struct MemoryBlock *freeList = pool->freeList;
+
+    if (pool->freeList == NULL) {
+        pool->freeList = block;
+        block->next = NULL;
+    } else if (block < pool->freeList) {
+        if ((u8 *) pool->freeList == (u8 *) block + block->size) {
+            block->size += freeList->size;
+            block->next = freeList->next;
+        } else {
+            block->next = pool->freeList;
+        }
+        pool->freeList = block;
+    } else {
+        while (freeList->next != NULL && freeList->next < block) {
+            freeList = freeList->next;
+        }
+        if ((u8 *) freeList + freeList->size == (u8 *) block) {
+            freeList->size += block->size;
+            block = freeList;
+        } else {
+            block->next = freeList->next;
+            freeList->next = block;
+        }
+        if (block->next != NULL && (u8 *) block->next == (u8 *) block + block->size) {
+            block->size += block->next->size;
+            block->next = block->next->next;
+        }
+    }
+}
+
+/**
+ * Move the blocks in the size class lists back to the main free list, so that they can
+ * be merged into larger blocks.
+ */
+static void mem_pool_flush_quick_lists(struct MemoryPool *pool) {
+    struct MemoryBlock *block;
+    s32 i;
+
+    for (i = 0; i < MEM_POOL_QUICK_CLASSES; i++) {
+        while ((block = pool->quickLists[i]) != NULL) {
+            pool->quickLists[i] = block->next;
+            mem_pool_list_free(pool, block);
+        }
+    }
+    pool->quickSpace = 0;
+    pool->flushes++;
+}
+
+/**
+ * Allocate from a memory pool. Return NULL if there is not enough space.
+ * Small blocks that were freed before are reused from their size class list in O(1).
+ */
+void *mem_pool_alloc(struct MemoryPool *pool, u32 size) {
+    struct MemoryBlock *block;
+    void *addr;
+
+    size = ALIGN8(size) + sizeof(struct MemoryBlock);
+    if (size <= MEM_POOL_QUICK_MAX && (block = pool->quickLists[MEM_POOL_QUICK_CLASS(size)]) != NULL) {
+        pool->quickLists[MEM_POOL_QUICK_CLASS(size)] = block->next;
+        pool->quickSpace -= size;
+        pool->quickAllocs++;
+        addr = (u8 *) block + sizeof(struct MemoryBlock);
+    } else {
+        addr = mem_pool_list_alloc(pool, size);
+        if (addr == NULL && pool->quickSpace != 0) {
+            mem_pool_flush_quick_lists(pool);
+            addr = mem_pool_list_alloc(pool, size);
+        }
+        if (addr == NULL) {
+            pool->failedAllocs++;
+            return NULL;
+        }
+        pool->listAllocs++;
+    }
+
+    // The block can be larger than requested if the remainder was too small to split off
+    pool->usedSpace += ((struct MemoryBlock *) ((u8 *) addr - sizeof(struct MemoryBlock)))->size;
+#ifdef MEMORY_STATS
+    if (pool == gEffectsMemoryPool) {
+        memory_stats_effects(pool);
+    }
+#endif
+    return addr;
+}
+
+/**
+ * Free a block that was allocated using mem_pool_alloc.
+ */
+void mem_pool_free(struct MemoryPool *pool, void *addr) {
+    struct MemoryBlock *block = (struct MemoryBlock *) ((u8 *) addr - sizeof(struct MemoryBlock));
+
+    pool->usedSpace -= block->size;
+    if (block->size <= MEM_POOL_QUICK_MAX && pool->quickSpace + block->size <= pool->totalSpace / 4) {
+        block->next = pool->quickLists[MEM_POOL_QUICK_CLASS(block->size)];
+        pool->quickLists[MEM_POOL_QUICK_CLASS(block->size)] = block;
+        pool->quickSpace += block->size;
+    } else {
+        mem_pool_list_free(pool, block);
+    }
+}
+
+void mem_pool_get_stats(struct MemoryPool *pool, struct MemoryPoolStats *stats) {
+    struct MemoryBlock *block;
+    s32 i;
+
+    bzero(stats, sizeof(*stats));
+    stats->totalSpace = pool->totalSpace;
+    stats->usedSpace = pool->usedSpace;
+    stats->quickSpace = pool->quickSpace;
+    for (i = 0; i < MEM_POOL_QUICK_CLASSES; i++) {
+        for (block = pool->quickLists[i]; block != NULL; block = block->next) {
+            stats->quickBlocks++;
+        }
+    }
+    for (block = pool->freeList; block != NULL; block = block->next) {
+        stats->freeSpace += block->size;
+        stats->freeBlocks++;
+        if (block->size > stats->largestFree) {
+            stats->largestFree = block->size;
+        }
+    }
+    stats->quickAllocs = pool->quickAllocs;
+    stats->listAllocs = pool->listAllocs;
+    stats->flushes = pool->flushes;
+    stats->failedAllocs = pool->failedAllocs;
+}
+#endif
+
+#ifndef TARGET_N64
+// The master display list grows up from the start of the gfx pool while alloc_display_list
+// takes memory down from its end. Instead of letting the two run into each other, the
+// master list branches to an overflow chunk once less than GFX_POOL_HEADROOM bytes are
+// left between them, and the chunk is then shared the same way. That many bytes are enough
+// for what the HUD and the other unchecked writers add between two checks. Chunks are
+// allocated as scenes need them and reused in later frames.
+#define GFX_POOL_HEADROOM (2048 * sizeof(Gfx))
+#define GFX_POOL_CHUNK_SIZE (GFX_POOL_SIZE / 4 * sizeof(Gfx))
+
+struct GfxPoolChunk {
+    struct GfxPoolChunk *next;
+    u32 size;
+    Gfx *buffer;
+};
+
+struct GfxPoolChain {
+    struct GfxPoolChunk *chunks;
+    struct GfxPoolChunk *curChunk; // NULL while the frame is still in its gfx pool
+    Gfx *regionStart;              // Start and end of the pool or chunk in use
+    u8 *regionEnd;
+    u32 frameUsed; // Used by the frame in the regions it is done with
+};
+
+static struct GfxPoolChain sGfxPoolChain;
+
+struct DisplayListPoolStats gDisplayListPoolStats;
+
+static u32 display_list_pool_region_used(void) {
+    return ((u8 *) gDisplayListHead - (u8 *) sGfxPoolChain.regionStart)
+           + (sGfxPoolChain.regionEnd - gGfxPoolEnd);
+}
+
+/**
+ * Branch the master list to the next overflow chunk with room for an allocation of size
+ * bytes, allocating it if needed. Returns FALSE if there is no memory for it.
+ */
+static s32 display_list_pool_chain(u32 size) {
+    struct GfxPoolChunk **link =
+        sGfxPoolChain.curChunk != NULL ? &sGfxPoolChain.curChunk->next : &sGfxPoolChain.chunks;
+    struct GfxPoolChunk *chunk = *link;
+    u32 needed = size + 2 * GFX_POOL_HEADROOM;
+
+    if (chunk == NULL || chunk->size < needed) {
+        chunk = malloc(sizeof(struct GfxPoolChunk));
+        if (chunk == NULL) {
+            return FALSE;
+        }
+        chunk->size = needed > GFX_POOL_CHUNK_SIZE ? ALIGN16(needed) : GFX_POOL_CHUNK_SIZE;
+        chunk->buffer = malloc(chunk->size);
+        if (chunk->buffer == NULL) {
+            free(chunk);
+            return FALSE;
+        }
+        // Chunks that are too small stay after it, for the frames that need less
+        chunk->next = *link;
+        *link = chunk;
+        gDisplayListPoolStats.chunkSpace += chunk->size;
+    }
+
+    sGfxPoolChain.frameUsed += display_list_pool_region_used() + sizeof(Gfx);
+    gSPBranchList(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(chunk->buffer));
+    gDisplayListHead = chunk->buffer;
+    gGfxPoolEnd = (u8 *) chunk->buffer + chunk->size;
+    sGfxPoolChain.curChunk = chunk;
+    sGfxPoolChain.regionStart = gDisplayListHead;
+    sGfxPoolChain.regionEnd = gGfxPoolEnd;
+    gDisplayListPoolStats.overflows++;
+    return TRUE;
+}
+
+/**
+ * Start a frame in the gfx pool gDisplayListHead and gGfxPoolEnd were just set to.
+ */
+void display_list_pool_init(void) {
+    sGfxPoolChain.curChunk = NULL;
+    sGfxPoolChain.regionStart = gDisplayListHead;
+    sGfxPoolChain.regionEnd = gGfxPoolEnd;
+    sGfxPoolChain.frameUsed = 0;
+    gDisplayListPoolStats.poolSize = gGfxPoolEnd - (u8 *) gDisplayListHead;
+}
+
+/**
+ * Move the master list to an overflow chunk if it is about to run into the allocations.
+ */
+void display_list_pool_check(void) {
+    if ((u32) (gGfxPoolEnd - (u8 *) gDisplayListHead) < GFX_POOL_HEADROOM) {
+        display_list_pool_chain(0);
+    }
+}
+
+/**
+ * Record the usage of the frame whose master list was just ended.
+ */
+void display_list_pool_end_frame(void) {
+    u32 used = sGfxPoolChain.frameUsed + display_list_pool_region_used();
+#ifdef MEMORY_STATS
+    struct MemoryStats *level = memory_stats_level();
+
+    if (level != NULL && used > level->displayListPeak) {
+        level->displayListPeak = used;
+    }
+#endif
+
+    gDisplayListPoolStats.frameUsed = used;
+    if (used > gDisplayListPoolStats.peakUsed) {
+        gDisplayListPoolStats.peakUsed = used;
+    }
+    if (sGfxPoolChain.curChunk != NULL) {
+        gDisplayListPoolStats.overflowFrames++;
+    }
+}
+
+// The chunks outlive save states, and the usage counts shouldn't go back in time either
+void display_list_pool_savestate_exclude(void (*exclude)(void *addr, u32 size)) {
+    exclude(&sGfxPoolChain, sizeof(sGfxPoolChain));
+    exclude(&gDisplayListPoolStats, sizeof(gDisplayListPoolStats));
+}
+#endif
 
 void *alloc_display_list(u32 size) {
     void *ptr = NULL;
 
     size = ALIGN8(size);
+#ifndef TARGET_N64
+    if ((u32) (gGfxPoolEnd - (u8 *) gDisplayListHead) < size + GFX_POOL_HEADROOM) {
+        display_list_pool_chain(size);
+    }
+#endif
     if (gGfxPoolEnd - size >= (u8 *) gDisplayListHead) {
         gGfxPoolEnd -= size;
         ptr = gGfxPoolEnd;
     } else {
+#ifndef TARGET_N64
+        gDisplayListPoolStats.failedAllocs++;
+#endif
     }
     return ptr;
 }
@@ -19,6 +19,31 @@ struct AllocOnlyPool
 
 struct MemoryPool;
 
+#ifdef SEGMENT_LOAD_STATS
+struct SegmentLoadStats
+{
+    u32 loads;
+    u32 romBytes; // Bytes read from ROM, compressed or not
+    OSTime time;  // In CPU counter ticks, see OS_CYCLES_TO_USEC
+};
+
+extern struct SegmentLoadStats gSegmentLoadStats;
+#endif
+
+#ifdef MIO0_CACHE_SIZE
+struct Mio0CacheStats
+{
+    u32 hits;
+    u32 misses;
+    u32 evictions;
+    u32 numEntries;
+    u32 usedSpace;
+    u32 totalSpace;
+};
+
+extern struct Mio0CacheStats gMio0CacheStats;
+#endif
+
 #ifndef INCLUDED_FROM_MEMORY_C
 // Declaring this variable extern puts it in the wrong place in the bss order
 // when this file is included from memory.c (first instead of last). Hence,
@@ -46,6 +71,9 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd);
 void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd);
 void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd);
 void load_engine_code_segment(void);
+#ifdef MIO0_CACHE_SIZE
+void mio0_cache_init(void *start, u32 size);
+#endif
 #else
 #define load_segment(...)
 #define load_to_fixed_pool_addr(...)
@@ -62,7 +90,97 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side);
 void *mem_pool_alloc(struct MemoryPool *pool, u32 size);
 void mem_pool_free(struct MemoryPool *pool, void *addr);
 
+#ifndef TARGET_N64
+struct MemoryPoolStats
+{
+    u32 totalSpace;
+    u32 usedSpace;    // Allocated, block headers included
+    u32 freeSpace;    // In the main free list
+    u32 largestFree;  // Largest block in the main free list
+    u32 freeBlocks;   // Blocks in the main free list
+    u32 quickSpace;   // Freed small blocks waiting in the size class lists
+    u32 quickBlocks;
+    u32 quickAllocs;  // Allocations served from a size class list
+    u32 listAllocs;   // Allocations served from the main free list
+    u32 flushes;      // Times the size class lists were merged back to make room
+    u32 failedAllocs;
+};
+
+void mem_pool_get_stats(struct MemoryPool *pool, struct MemoryPoolStats *stats);
+#endif
+
 void *alloc_display_list(u32 size);
+
+#ifndef TARGET_N64
+// Usage of the gfx pool and its overflow chunks (see alloc_display_list), in bytes
+struct DisplayListPoolStats
+{
+    u32 poolSize;          // The gfx pool of one frame
+    u32 frameUsed;         // Used by the last frame, master list and allocations together
+    u32 peakUsed;
+    u32 chunkSpace;        // Overflow chunks allocated so far
+    u32 overflows;         // Times a frame moved on to another overflow chunk
+    u32 overflowFrames;    // Frames that didn't fit in their gfx pool
+    u32 listNodeOverflows; // Scene graph list nodes that didn't fit in gDisplayListHeap
+    u32 failedAllocs;
+};
+
+extern struct DisplayListPoolStats gDisplayListPoolStats;
+
+void display_list_pool_init(void);
+void display_list_pool_check(void);
+void display_list_pool_end_frame(void);
+void display_list_pool_savestate_exclude(void (*exclude)(void *addr, u32 size));
+#endif
+
+#ifdef MEMORY_STATS
+#include <stdio.h>
+
+#define MEMORY_STATS_MAX_SITES 64
+
+// High-water marks, in bytes. Allocation-only pools that take all the remaining space
+// (sLevelPool, gDisplayListHeap) only count what they have used.
+struct MemoryStats
+{
+    u32 leftPeak;
+    u32 rightPeak;
+    u32 effectsPeak;   // gEffectsMemoryPool
+    u32 levelPoolPeak; // sLevelPool
+    u32 displayListPeak; // The gfx pool and its overflow chunks, in one frame
+    u32 failedAllocs;
+    const char *leftPeakSite;
+    const char *rightPeakSite;
+};
+
+struct MemoryStatsSite
+{
+    const char *site;
+    u32 calls;
+    u32 largest;  // Largest single allocation
+    u32 sidePeak; // Highest usage of its side of the pool right after one of its allocations
+    u32 side;
+};
+
+extern struct MemoryStats gMemoryStats;
+extern struct MemoryStats gLevelMemoryStats[];
+extern struct MemoryStatsSite gMemoryStatsSites[MEMORY_STATS_MAX_SITES];
+extern s32 gMemoryStatsSiteCount;
+extern const char *gMemoryStatsSite;
+
+void memory_stats_level_pool(u32 usedSpace);
+void memory_stats_print(FILE *file);
+
+#ifndef INCLUDED_FROM_MEMORY_C
+#define MEMORY_STATS_STR2(x) #x
+#define MEMORY_STATS_STR(x) MEMORY_STATS_STR2(x)
+#define MEMORY_STATS_HERE (gMemoryStatsSite = __FILE__ ":" MEMORY_STATS_STR(__LINE__))
+
+// Tag allocations with their call site
+#define main_pool_alloc(size, side) (MEMORY_STATS_HERE, main_pool_alloc(size, side))
+#define alloc_only_pool_init(size, side) (MEMORY_STATS_HERE, alloc_only_pool_init(size, side))
+#define mem_pool_init(size, side) (MEMORY_STATS_HERE, mem_pool_init(size, side))
+#endif
+#endif
 void func_80278A78(struct MarioAnimation *a, void *b, struct Animation *target);
 s32 load_patchable_table(struct MarioAnimation *a, u32 b);
 
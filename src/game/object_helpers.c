@@ -871,9 +871,24 @@ struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *b
     uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
     struct Object *closestObj = NULL;
     struct Object *obj;
+#ifdef TARGET_N64
     struct ObjectNode *listHead;
+#endif
     f32 minDist = 0x20000;
 
+#ifndef TARGET_N64
+    // Only visit the objects with this behavior, in the same order as the scan below
+    for (obj = behavior_index_first(behaviorAddr, get_object_list_from_behavior(behaviorAddr)); obj != NULL;
+         obj = behavior_index_next(obj)) {
+        if (obj->activeFlags != ACTIVE_FLAG_DEACTIVATED && obj != o) {
+            f32 objDist = dist_between_objects(o, obj);
+            if (objDist < minDist) {
+                closestObj = obj;
+                minDist = objDist;
+            }
+        }
+    }
+#else
     listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
     obj = (struct Object *) listHead->next;
 
@@ -889,6 +904,7 @@ struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *b
         }
         obj = (struct Object *) obj->header.next;
     }
+#endif
 
     *dist = minDist;
     return closestObj;
@@ -920,6 +936,15 @@ s32 count_unimportant_objects(void) {
 
 s32 count_objects_with_behavior(const BehaviorScript *behavior) {
     uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
+#ifndef TARGET_N64
+    struct Object *obj;
+    s32 count = 0;
+
+    for (obj = behavior_index_first(behaviorAddr, get_object_list_from_behavior(behaviorAddr)); obj != NULL;
+         obj = behavior_index_next(obj)) {
+        count++;
+    }
+#else
     struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
     struct ObjectNode *obj = listHead->next;
     s32 count = 0;
@@ -931,16 +956,34 @@ s32 count_objects_with_behavior(const BehaviorScript *behavior) {
 
         obj = obj->next;
     }
+#endif
 
     return count;
 }
 
 struct Object *cur_obj_find_nearby_held_actor(const BehaviorScript *behavior, f32 maxDist) {
     const BehaviorScript *behaviorAddr = segmented_to_virtual(behavior);
+#ifdef TARGET_N64
     struct ObjectNode *listHead;
+#endif
     struct Object *obj;
     struct Object *foundObj;
 
+#ifndef TARGET_N64
+    foundObj = NULL;
+    for (obj = behavior_index_first(behaviorAddr, OBJ_LIST_GENACTOR); obj != NULL; obj = behavior_index_next(obj)) {
+        if (obj->activeFlags != ACTIVE_FLAG_DEACTIVATED) {
+            // This includes the dropped and thrown states. By combining instant
+            // release, this allows us to activate mama penguin remotely
+            if (obj->oHeldState != HELD_FREE) {
+                if (dist_between_objects(o, obj) < maxDist) {
+                    foundObj = obj;
+                    break;
+                }
+            }
+        }
+    }
+#else
     listHead = &gObjectLists[OBJ_LIST_GENACTOR];
     obj = (struct Object *) listHead->next;
     foundObj = NULL;
@@ -961,6 +1004,7 @@ struct Object *cur_obj_find_nearby_held_actor(const BehaviorScript *behavior, f3
 
         obj = (struct Object *) obj->header.next;
     }
+#endif
 
     return foundObj;
 }
@@ -1491,10 +1535,16 @@ s32 obj_check_if_collided_with_object(struct Object *obj1, struct Object *obj2)
 
 void cur_obj_set_behavior(const BehaviorScript *behavior) {
     o->behavior = segmented_to_virtual(behavior);
+#ifndef TARGET_N64
+    behavior_index_update(o);
+#endif
 }
 
 void obj_set_behavior(struct Object *obj, const BehaviorScript *behavior) {
     obj->behavior = segmented_to_virtual(behavior);
+#ifndef TARGET_N64
+    behavior_index_update(obj);
+#endif
 }
 
 s32 cur_obj_has_behavior(const BehaviorScript *behavior) {
@@ -549,6 +549,9 @@ void clear_objects(void) {
     for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
         gObjectPool[i].activeFlags = ACTIVE_FLAG_DEACTIVATED;
         geo_reset_object_node(&gObjectPool[i].header.gfx);
+#ifndef TARGET_N64
+        geo_detach_object_node(&gObjectPool[i].header.gfx);
+#endif
     }
 
     gObjectMemoryPool = mem_pool_init(0x800, MEMORY_POOL_LEFT);
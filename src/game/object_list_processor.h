@@ -21,9 +21,14 @@
 
 
 /**
- * The maximum number of objects that can be loaded at once.
+ * The maximum number of objects that can be loaded at once. PC builds can change it
+ * with OBJECT_POOL_CAPACITY=n; pool slots are kept in s16s, which bounds it.
  */
+#ifndef OBJECT_POOL_CAPACITY
 #define OBJECT_POOL_CAPACITY 240
+#elif OBJECT_POOL_CAPACITY < 1 || OBJECT_POOL_CAPACITY > 0x7FFF
+#error "OBJECT_POOL_CAPACITY must be between 1 and 32767"
+#endif
 
 /**
  * Every object is categorized into an object list, which controls the order
@@ -189,6 +189,23 @@ struct Painting **sPaintingGroups[] = {
 s16 gPaintingUpdateCounter = 1;
 s16 gLastPaintingUpdateCounter = 0;
 
+#ifndef TARGET_N64
+/**
+ * The paintings keep their state in the level data, so save states have to copy them
+ * in addition to the game's globals.
+ */
+void painting_savestate_include(void (*include)(void *addr, u32 size)) {
+    s32 group;
+    s32 i;
+
+    for (group = 0; group < ARRAY_COUNT(sPaintingGroups); group++) {
+        for (i = 0; sPaintingGroups[group][i] != NULL; i++) {
+            include(segmented_to_virtual(sPaintingGroups[group][i]), sizeof(struct Painting));
+        }
+    }
+}
+#endif
+
 /**
  * Stop paintings in paintingGroup from rippling if their id is different from *idptr.
  */
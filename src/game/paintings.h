@@ -137,5 +137,8 @@ extern s8 gDddPaintingStatus;
 
 Gfx *geo_painting_draw(s32 callContext, struct GraphNode *node, UNUSED void *context);
 Gfx *geo_painting_update(s32 callContext, UNUSED struct GraphNode *node, UNUSED Mat4 c);
+#ifndef TARGET_N64
+void painting_savestate_include(void (*include)(void *addr, u32 size));
+#endif
 
 #endif // PAINTINGS_H
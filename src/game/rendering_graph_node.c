@@ -16,6 +16,15 @@
 #include "src/pc/gfx/color_conversion.h"
 #endif
 
+#ifdef THREAD_POOL
+#include <stdlib.h>
+#include <string.h>
+
+#include "object_helpers.h"
+#include "object_list_processor.h"
+#include "pc/thread_pool.h"
+#endif
+
 /**
  * This file contains the code that processes the scene graph for rendering.
  * The scene graph is responsible for drawing everything except the HUD / text boxes.
@@ -134,6 +143,84 @@ u16 gAreaUpdateCounter = 0;
 LookAt lookAt;
 #endif
 
+#ifdef THREAD_POOL
+/**
+ * With render threads, the object parent node first computes the matrices of all
+ * objects in parallel (phase 1), and the normal traversal then takes them in order
+ * instead of computing them again (phase 2). Phase 1 only takes objects whose geo
+ * layout doesn't call into game code (apart from geo_switch_anim_state, which it
+ * predicts), so everything with side effects still runs in the same order on the main
+ * thread. Phase 2 checks every matrix it takes against the node it is processing, and
+ * falls back to computing it for the rest of the object on any difference.
+ */
+#define GEO_PRECOMPUTED_MAX 32
+
+struct GeoPrecomputedMtx {
+    struct GraphNode *node;
+    Mat4 mtxf;
+    Mtx mtx;
+};
+
+struct GeoPrecomputedObject {
+    struct Object *obj;
+    Mat4 root; // The scaled object matrix phase 1 started from
+    struct GeoAnimState anim;
+    s32 count;
+    struct GeoPrecomputedMtx entries[GEO_PRECOMPUTED_MAX];
+};
+
+// Allocated as objects are queued, so only builds that use render threads pay for the
+// records, and only for as many objects as they draw, whatever OBJECT_POOL_CAPACITY is
+static struct {
+    struct GeoPrecomputedObject *records;
+    s32 capacity;
+} sPrecomputed;
+static s32 sPrecomputedCount;
+static s32 sPrecomputedNext;
+
+// The record of the object being processed, and the next entry to take from it
+static struct GeoPrecomputedObject *sCurPrecomputed;
+static s32 sCurPrecomputedIndex;
+
+/**
+ * If phase 1 computed the matrix of this node, push it on the float matrix stack
+ * above gMatStackIndex, copy the fixed point one to mtx and return TRUE.
+ */
+static s32 geo_use_precomputed(struct GraphNode *node, Mtx *mtx) {
+    struct GeoPrecomputedMtx *entry;
+
+    if (sCurPrecomputed == NULL) {
+        return FALSE;
+    }
+    entry = &sCurPrecomputed->entries[sCurPrecomputedIndex];
+    if (sCurPrecomputedIndex >= sCurPrecomputed->count || entry->node != node) {
+        sCurPrecomputed = NULL;
+        return FALSE;
+    }
+    sCurPrecomputedIndex++;
+    mtxf_copy(gMatStack[gMatStackIndex + 1], entry->mtxf);
+    *mtx = entry->mtx;
+    return TRUE;
+}
+#endif
+
+#ifndef TARGET_N64
+// Set when the game runs without being drawn (see src/pc/sim/sim.h). The scene graph is
+// still walked, because the camera, the animations and the held objects are updated on
+// the way, but no display lists are built.
+s8 gGeoSkipDisplayLists;
+
+// The precomputed matrices only live for one frame, so save states don't need them
+void geo_process_savestate_exclude(void (*exclude)(void *addr, u32 size)) {
+#ifdef THREAD_POOL
+    // The records are malloc'd, and restoring an old pointer to them would leak or dangle
+    exclude(&sPrecomputed, sizeof(sPrecomputed));
+#else
+    (void) exclude;
+#endif
+}
+#endif
+
 /**
  * Process a master list node.
  */
@@ -161,6 +248,9 @@ static void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
         if ((currList = node->listHeads[i]) != NULL) {
             gDPSetRenderMode(gDisplayListHead++, modeList->modes[i], mode2List->modes[i]);
             while (currList != NULL) {
+#ifndef TARGET_N64
+                display_list_pool_check();
+#endif
                 gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(currList->transform),
                           G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH);
                 gSPDisplayList(gDisplayListHead++, currList->displayList);
@@ -180,7 +270,15 @@ static void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
  * render modes of layers.
  */
 static void geo_append_display_list(void *displayList, s16 layer) {
+#ifndef TARGET_N64
+    if (gGeoSkipDisplayLists) {
+        return;
+    }
+#endif
 
+#ifndef TARGET_N64
+    display_list_pool_check();
+#endif
 #ifdef F3DEX_GBI_2
     gSPLookAt(gDisplayListHead++, &lookAt);
 #endif
@@ -188,6 +286,15 @@ static void geo_append_display_list(void *displayList, s16 layer) {
         struct DisplayListNode *listNode =
             alloc_only_pool_alloc(gDisplayListHeap, sizeof(struct DisplayListNode));
 
+#ifndef TARGET_N64
+        // The node is only needed until the master list is built, like the gfx pool's memory
+        if (listNode == NULL) {
+            gDisplayListPoolStats.listNodeOverflows++;
+            if ((listNode = alloc_display_list(sizeof(struct DisplayListNode))) == NULL) {
+                return;
+            }
+        }
+#endif
         listNode->transform = gMatStackFixed[gMatStackIndex];
         listNode->displayList = displayList;
         listNode->next = 0;
@@ -354,11 +461,18 @@ static void geo_process_translation_rotation(struct GraphNodeTranslationRotation
     Vec3f translation;
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
-    vec3s_to_vec3f(translation, node->translation);
-    mtxf_rotate_zxy_and_translate(mtxf, translation, node->rotation);
-    mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
-    gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, mtx)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        vec3s_to_vec3f(translation, node->translation);
+        mtxf_rotate_zxy_and_translate(mtxf, translation, node->rotation);
+        mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
+        gMatStackIndex++;
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -379,11 +493,18 @@ static void geo_process_translation(struct GraphNodeTranslation *node) {
     Vec3f translation;
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
-    vec3s_to_vec3f(translation, node->translation);
-    mtxf_rotate_zxy_and_translate(mtxf, translation, gVec3sZero);
-    mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
-    gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, mtx)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        vec3s_to_vec3f(translation, node->translation);
+        mtxf_rotate_zxy_and_translate(mtxf, translation, gVec3sZero);
+        mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
+        gMatStackIndex++;
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -403,10 +524,17 @@ static void geo_process_rotation(struct GraphNodeRotation *node) {
     Mat4 mtxf;
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
-    mtxf_rotate_zxy_and_translate(mtxf, gVec3fZero, node->rotation);
-    mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
-    gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, mtx)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        mtxf_rotate_zxy_and_translate(mtxf, gVec3fZero, node->rotation);
+        mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
+        gMatStackIndex++;
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -427,10 +555,17 @@ static void geo_process_scale(struct GraphNodeScale *node) {
     Vec3f scaleVec;
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
-    vec3f_set(scaleVec, node->scale, node->scale, node->scale);
-    mtxf_scale_vec3f(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], scaleVec);
-    gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, mtx)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        vec3f_set(scaleVec, node->scale, node->scale, node->scale);
+        mtxf_scale_vec3f(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], scaleVec);
+        gMatStackIndex++;
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -451,19 +586,26 @@ static void geo_process_billboard(struct GraphNodeBillboard *node) {
     Vec3f translation;
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
-    gMatStackIndex++;
-    vec3s_to_vec3f(translation, node->translation);
-    mtxf_billboard(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex - 1], translation,
-                   gCurGraphNodeCamera->roll);
-    if (gCurGraphNodeHeldObject != NULL) {
-        mtxf_scale_vec3f(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex],
-                         gCurGraphNodeHeldObject->objNode->header.gfx.scale);
-    } else if (gCurGraphNodeObject != NULL) {
-        mtxf_scale_vec3f(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex],
-                         gCurGraphNodeObject->scale);
-    }
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, mtx)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        gMatStackIndex++;
+        vec3s_to_vec3f(translation, node->translation);
+        mtxf_billboard(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex - 1], translation,
+                       gCurGraphNodeCamera->roll);
+        if (gCurGraphNodeHeldObject != NULL) {
+            mtxf_scale_vec3f(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex],
+                             gCurGraphNodeHeldObject->objNode->header.gfx.scale);
+        } else if (gCurGraphNodeObject != NULL) {
+            mtxf_scale_vec3f(gMatStack[gMatStackIndex], gMatStack[gMatStackIndex],
+                             gCurGraphNodeObject->scale);
+        }
 
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -514,6 +656,14 @@ static void geo_process_generated_list(struct GraphNodeGenerated *node) {
 static void geo_process_background(struct GraphNodeBackground *node) {
     Gfx *list = NULL;
 
+#ifndef TARGET_N64
+    if (gGeoSkipDisplayLists) {
+        if (node->fnNode.node.children != NULL) {
+            geo_process_node_and_siblings(node->fnNode.node.children);
+        }
+        return;
+    }
+#endif
     if (node->fnNode.func != NULL) {
         list = node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node,
                                  (struct AllocOnlyPool *) gMatStack[gMatStackIndex]);
@@ -602,10 +752,17 @@ static void geo_process_animated_part(struct GraphNodeAnimatedPart *node) {
         rotation[1] = gCurAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
         rotation[2] = gCurAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
     }
-    mtxf_rotate_xyz_and_translate(matrix, translation, rotation);
-    mtxf_mul(gMatStack[gMatStackIndex + 1], matrix, gMatStack[gMatStackIndex]);
-    gMatStackIndex++;
-    mtxf_to_mtx(matrixPtr, gMatStack[gMatStackIndex]);
+#ifdef THREAD_POOL
+    if (geo_use_precomputed(&node->node, matrixPtr)) {
+        gMatStackIndex++;
+    } else
+#endif
+    {
+        mtxf_rotate_xyz_and_translate(matrix, translation, rotation);
+        mtxf_mul(gMatStack[gMatStackIndex + 1], matrix, gMatStack[gMatStackIndex]);
+        gMatStackIndex++;
+        mtxf_to_mtx(matrixPtr, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = matrixPtr;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -703,8 +860,16 @@ static void geo_process_shadow(struct GraphNodeShadow *node) {
             }
         }
 
+#ifdef TARGET_N64
         shadowList = create_shadow_below_xyz(shadowPos[0], shadowPos[1], shadowPos[2], shadowScale,
                                              node->shadowSolidity, node->shadowType);
+#else
+        // The animation part above still has to run, it moves gCurrAnimAttribute
+        shadowList = gGeoSkipDisplayLists ? NULL
+                                          : create_shadow_below_xyz(shadowPos[0], shadowPos[1], shadowPos[2],
+                                                                    shadowScale, node->shadowSolidity,
+                                                                    node->shadowType);
+#endif
         if (shadowList != NULL) {
             mtx = alloc_display_list(sizeof(*mtx));
             gMatStackIndex++;
@@ -816,12 +981,337 @@ static int obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
     return TRUE;
 }
 
+#ifdef THREAD_POOL
+// State of a phase 1 walk, a private copy of the matrix stack and the animation globals
+struct GeoPrecomputeWalk {
+    struct GeoPrecomputedObject *rec;
+    struct GeoAnimState anim;
+    s32 stackIndex;
+    Mat4 stack[GEO_PRECOMPUTED_MAX + 2];
+};
+
+static s32 geo_precompute_node_and_siblings(struct GeoPrecomputeWalk *walk, struct GraphNode *firstNode,
+                                            s32 iterateChildren);
+
+static s32 geo_precompute_children(struct GeoPrecomputeWalk *walk, struct GraphNode *node) {
+    if (node->children == NULL) {
+        return TRUE;
+    }
+    return geo_precompute_node_and_siblings(walk, node->children,
+                                            node->type != GRAPH_NODE_TYPE_SWITCH_CASE);
+}
+
+/**
+ * Like geo_set_animation_globals, without writing back to the object.
+ */
+static void geo_precompute_animation_globals(struct GeoAnimState *anim, struct Object *obj) {
+    struct GraphNodeObject_sub animInfo = obj->header.gfx.unk38;
+    struct Animation *curAnim = animInfo.curAnim;
+
+    if (obj->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION) {
+        animInfo.animFrame = geo_update_animation_frame(&animInfo, &animInfo.animFrameAccelAssist);
+    }
+    if (curAnim->flags & ANIM_FLAG_HOR_TRANS) {
+        anim->type = ANIM_TYPE_VERTICAL_TRANSLATION;
+    } else if (curAnim->flags & ANIM_FLAG_VERT_TRANS) {
+        anim->type = ANIM_TYPE_LATERAL_TRANSLATION;
+    } else if (curAnim->flags & ANIM_FLAG_6) {
+        anim->type = ANIM_TYPE_NO_TRANSLATION;
+    } else {
+        anim->type = ANIM_TYPE_TRANSLATION;
+    }
+
+    anim->frame = animInfo.animFrame;
+    anim->enabled = (curAnim->flags & ANIM_FLAG_5) == 0;
+    anim->attribute = segmented_to_virtual((void *) curAnim->index);
+    anim->data = segmented_to_virtual((void *) curAnim->values);
+
+    if (curAnim->unk02 == 0) {
+        anim->translationMultiplier = 1.0f;
+    } else {
+        anim->translationMultiplier = (f32) animInfo.animYTrans / (f32) curAnim->unk02;
+    }
+}
+
+/**
+ * Like the animation part of geo_process_animated_part, on the walk's copy of the globals.
+ */
+static void geo_precompute_animated_part(struct GeoAnimState *anim, struct GraphNodeAnimatedPart *node,
+                                         Vec3f translation, Vec3s rotation) {
+    vec3s_copy(rotation, gVec3sZero);
+    vec3f_set(translation, node->translation[0], node->translation[1], node->translation[2]);
+    if (anim->type == ANIM_TYPE_TRANSLATION) {
+        translation[0] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        translation[1] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        translation[2] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        anim->type = ANIM_TYPE_ROTATION;
+    } else if (anim->type == ANIM_TYPE_LATERAL_TRANSLATION) {
+        translation[0] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        anim->attribute += 2;
+        translation[2] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        anim->type = ANIM_TYPE_ROTATION;
+    } else if (anim->type == ANIM_TYPE_VERTICAL_TRANSLATION) {
+        anim->attribute += 2;
+        translation[1] += anim->data[retrieve_animation_index(anim->frame, &anim->attribute)]
+                          * anim->translationMultiplier;
+        anim->attribute += 2;
+        anim->type = ANIM_TYPE_ROTATION;
+    } else if (anim->type == ANIM_TYPE_NO_TRANSLATION) {
+        anim->attribute += 6;
+        anim->type = ANIM_TYPE_ROTATION;
+    }
+
+    if (anim->type == ANIM_TYPE_ROTATION) {
+        rotation[0] = anim->data[retrieve_animation_index(anim->frame, &anim->attribute)];
+        rotation[1] = anim->data[retrieve_animation_index(anim->frame, &anim->attribute)];
+        rotation[2] = anim->data[retrieve_animation_index(anim->frame, &anim->attribute)];
+    }
+}
+
+/**
+ * Evaluate one node the way its geo_process function would, with the matrix it pushes
+ * computed in walk->stack. Returns FALSE for nodes that call game code or need other
+ * state from the traversal, which gives up on the object.
+ */
+static s32 geo_precompute_node(struct GeoPrecomputeWalk *walk, struct GraphNode *node) {
+    Mat4 *parentMtx = &walk->stack[walk->stackIndex];
+    Mat4 *mtxf = &walk->stack[walk->stackIndex + 1];
+    Mat4 matrix;
+    Vec3f translation;
+    Vec3s rotation;
+    struct GraphNode *selectedChild;
+    s32 result;
+    s32 i;
+
+    if (node->flags & GRAPH_RENDER_CHILDREN_FIRST) {
+        return geo_precompute_children(walk, node);
+    }
+
+    switch (node->type) {
+        case GRAPH_NODE_TYPE_START:
+        case GRAPH_NODE_TYPE_CULLING_RADIUS:
+        case GRAPH_NODE_TYPE_DISPLAY_LIST:
+        case GRAPH_NODE_TYPE_SHADOW:
+            return geo_precompute_children(walk, node);
+        case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL:
+            // geo_process_level_of_detail always takes distance 0 outside of N64 builds
+            if (((struct GraphNodeLevelOfDetail *) node)->minDistance <= 0
+                && 0 < ((struct GraphNodeLevelOfDetail *) node)->maxDistance) {
+                return geo_precompute_children(walk, node);
+            }
+            return TRUE;
+        case GRAPH_NODE_TYPE_SWITCH_CASE: {
+            struct GraphNodeSwitchCase *switchCase = (struct GraphNodeSwitchCase *) node;
+            s16 selectedCase = switchCase->selectedCase;
+
+            // geo_switch_anim_state is the only selection function that is predictable here
+            if (switchCase->fnNode.func == (GraphNodeFunc) geo_switch_anim_state) {
+                selectedCase = walk->rec->obj->oAnimState >= switchCase->numCases
+                                   ? 0 : walk->rec->obj->oAnimState;
+            } else if (switchCase->fnNode.func != NULL) {
+                return FALSE;
+            }
+            selectedChild = node->children;
+            for (i = 0; selectedChild != NULL && selectedCase > i; i++) {
+                selectedChild = selectedChild->next;
+            }
+            return selectedChild == NULL || geo_precompute_node_and_siblings(walk, selectedChild, FALSE);
+        }
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION:
+            vec3s_to_vec3f(translation, ((struct GraphNodeTranslationRotation *) node)->translation);
+            mtxf_rotate_zxy_and_translate(matrix, translation,
+                                          ((struct GraphNodeTranslationRotation *) node)->rotation);
+            mtxf_mul(*mtxf, matrix, *parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_TRANSLATION:
+            vec3s_to_vec3f(translation, ((struct GraphNodeTranslation *) node)->translation);
+            mtxf_rotate_zxy_and_translate(matrix, translation, gVec3sZero);
+            mtxf_mul(*mtxf, matrix, *parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_ROTATION:
+            mtxf_rotate_zxy_and_translate(matrix, gVec3fZero, ((struct GraphNodeRotation *) node)->rotation);
+            mtxf_mul(*mtxf, matrix, *parentMtx);
+            break;
+        case GRAPH_NODE_TYPE_SCALE:
+            vec3f_set(translation, ((struct GraphNodeScale *) node)->scale,
+                      ((struct GraphNodeScale *) node)->scale, ((struct GraphNodeScale *) node)->scale);
+            mtxf_scale_vec3f(*mtxf, *parentMtx, translation);
+            break;
+        case GRAPH_NODE_TYPE_BILLBOARD:
+            vec3s_to_vec3f(translation, ((struct GraphNodeBillboard *) node)->translation);
+            mtxf_billboard(*mtxf, *parentMtx, translation, gCurGraphNodeCamera->roll);
+            mtxf_scale_vec3f(*mtxf, *mtxf, walk->rec->obj->header.gfx.scale);
+            break;
+        case GRAPH_NODE_TYPE_ANIMATED_PART:
+            geo_precompute_animated_part(&walk->anim, (struct GraphNodeAnimatedPart *) node, translation,
+                                         rotation);
+            mtxf_rotate_xyz_and_translate(matrix, translation, rotation);
+            mtxf_mul(*mtxf, matrix, *parentMtx);
+            break;
+        default:
+            return FALSE;
+    }
+
+    if (walk->rec->count == GEO_PRECOMPUTED_MAX) {
+        return FALSE;
+    }
+    walk->rec->entries[walk->rec->count].node = node;
+    mtxf_copy(walk->rec->entries[walk->rec->count].mtxf, *mtxf);
+    mtxf_to_mtx(&walk->rec->entries[walk->rec->count].mtx, *mtxf);
+    walk->rec->count++;
+
+    walk->stackIndex++;
+    result = geo_precompute_children(walk, node);
+    walk->stackIndex--;
+    return result;
+}
+
+static s32 geo_precompute_node_and_siblings(struct GeoPrecomputeWalk *walk, struct GraphNode *firstNode,
+                                            s32 iterateChildren) {
+    struct GraphNode *curGraphNode = firstNode;
+
+    do {
+        if ((curGraphNode->flags & GRAPH_RENDER_ACTIVE) && !geo_precompute_node(walk, curGraphNode)) {
+            return FALSE;
+        }
+    } while (iterateChildren && (curGraphNode = curGraphNode->next) != firstNode);
+    return TRUE;
+}
+
+/**
+ * Phase 1 task: compute the object matrix like geo_process_object, then walk the object's
+ * geo layout. Runs on the thread pool while the main thread waits, so it only reads
+ * shared state.
+ */
+static void geo_precompute_object(UNUSED void *arg, int index) {
+    struct GeoPrecomputedObject *rec = &sPrecomputed.records[index];
+    struct Object *obj = rec->obj;
+    struct GeoPrecomputeWalk walk;
+    Mat4 mtxf;
+
+    rec->count = 0;
+    if (obj->header.gfx.throwMatrix != NULL) {
+        mtxf_mul(walk.stack[0], *obj->header.gfx.throwMatrix, gMatStack[gMatStackIndex]);
+    } else if (obj->header.gfx.node.flags & GRAPH_RENDER_BILLBOARD) {
+        mtxf_billboard(walk.stack[0], gMatStack[gMatStackIndex], obj->header.gfx.pos,
+                       gCurGraphNodeCamera->roll);
+    } else {
+        mtxf_rotate_zxy_and_translate(mtxf, obj->header.gfx.pos, obj->header.gfx.angle);
+        mtxf_mul(walk.stack[0], mtxf, gMatStack[gMatStackIndex]);
+    }
+    mtxf_scale_vec3f(walk.stack[0], walk.stack[0], obj->header.gfx.scale);
+    mtxf_copy(rec->root, walk.stack[0]);
+
+    walk.anim.type = ANIM_TYPE_NONE;
+    if (obj->header.gfx.unk38.curAnim != NULL) {
+        geo_precompute_animation_globals(&walk.anim, obj);
+    }
+    rec->anim = walk.anim;
+
+    if (obj->header.gfx.sharedChild != NULL && obj_is_in_view(&obj->header.gfx, walk.stack[0])) {
+        walk.rec = rec;
+        walk.stackIndex = 0;
+        // A callback later in the traversal can still change nodes this walk has already
+        // read, so only objects with no callbacks at all are taken ahead
+        if (!geo_precompute_node_and_siblings(&walk, obj->header.gfx.sharedChild, TRUE)) {
+            rec->count = 0;
+        }
+    }
+}
+
+/**
+ * Make room for a record at index, growing the records. Returns FALSE if there is none.
+ */
+static s32 geo_precomputed_reserve(s32 index) {
+    struct GeoPrecomputedObject *records;
+    s32 capacity;
+
+    if (index < sPrecomputed.capacity) {
+        return TRUE;
+    }
+    if (index >= OBJECT_POOL_CAPACITY) {
+        return FALSE;
+    }
+    capacity = sPrecomputed.capacity != 0 ? sPrecomputed.capacity * 2 : 64;
+    if (capacity > OBJECT_POOL_CAPACITY) {
+        capacity = OBJECT_POOL_CAPACITY;
+    }
+    records = realloc(sPrecomputed.records, capacity * sizeof(struct GeoPrecomputedObject));
+    if (records == NULL) {
+        return FALSE;
+    }
+    sPrecomputed.records = records;
+    sPrecomputed.capacity = capacity;
+    return TRUE;
+}
+
+/**
+ * Phase 1: compute the matrices of the objects under the object parent node on the
+ * thread pool, in the order geo_process_object will see them.
+ */
+static void geo_precompute_objects(struct GraphNode *objList) {
+    struct GraphNode *curGraphNode;
+
+    sPrecomputedCount = 0;
+    sPrecomputedNext = 0;
+    if (thread_pool_size() == 0 || gCurGraphNodeCamera == NULL || gCurGraphNodeCamFrustum == NULL
+        || objList->type != GRAPH_NODE_TYPE_START || !(objList->flags & GRAPH_RENDER_ACTIVE)
+        || objList->children == NULL) {
+        return;
+    }
+
+    curGraphNode = objList->children;
+    do {
+        if ((curGraphNode->flags & GRAPH_RENDER_ACTIVE) && !(curGraphNode->flags & GRAPH_RENDER_CHILDREN_FIRST)
+            && curGraphNode->type == GRAPH_NODE_TYPE_OBJECT
+            && ((struct Object *) curGraphNode)->header.gfx.unk18 == gCurGraphNodeRoot->areaIndex
+            && geo_precomputed_reserve(sPrecomputedCount)) {
+            sPrecomputed.records[sPrecomputedCount++].obj = (struct Object *) curGraphNode;
+        }
+    } while ((curGraphNode = curGraphNode->next) != objList->children);
+
+    thread_pool_run(geo_precompute_object, NULL, sPrecomputedCount);
+}
+
+/**
+ * Phase 2: called by geo_process_object after it has set up the object matrix and the
+ * animation globals. Takes the object's record if it was computed from the same state.
+ */
+static void geo_start_precomputed(struct GeoPrecomputedObject *rec) {
+    sCurPrecomputed = NULL;
+    if (rec == NULL || rec->count == 0 || memcmp(rec->root, gMatStack[gMatStackIndex], sizeof(Mat4)) != 0
+        || rec->anim.type != gCurAnimType) {
+        return;
+    }
+    if (rec->anim.type != ANIM_TYPE_NONE
+        && (rec->anim.frame != gCurrAnimFrame || rec->anim.enabled != gCurAnimEnabled
+            || rec->anim.attribute != gCurrAnimAttribute || rec->anim.data != gCurAnimData
+            || rec->anim.translationMultiplier != gCurAnimTranslationMultiplier)) {
+        return;
+    }
+    sCurPrecomputed = rec;
+    sCurPrecomputedIndex = 0;
+}
+#endif
+
 /**
  * Process an object node.
  */
 static void geo_process_object(struct Object *node) {
     Mat4 mtxf;
     s32 hasAnimation = (node->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION) != 0;
+#ifdef THREAD_POOL
+    struct GeoPrecomputedObject *precomputed = NULL;
+
+    if (sPrecomputedNext < sPrecomputedCount && sPrecomputed.records[sPrecomputedNext].obj == node) {
+        precomputed = &sPrecomputed.records[sPrecomputedNext++];
+    }
+#endif
 
     if (node->header.gfx.unk18 == gCurGraphNodeRoot->areaIndex) {
         if (node->header.gfx.throwMatrix != NULL) {
@@ -854,7 +1344,13 @@ static void geo_process_object(struct Object *node) {
             if (node->header.gfx.sharedChild != NULL) {
                 gCurGraphNodeObject = (struct GraphNodeObject *) node;
                 node->header.gfx.sharedChild->parent = &node->header.gfx.node;
+#ifdef THREAD_POOL
+                geo_start_precomputed(precomputed);
+#endif
                 geo_process_node_and_siblings(node->header.gfx.sharedChild);
+#ifdef THREAD_POOL
+                sCurPrecomputed = NULL;
+#endif
                 node->header.gfx.sharedChild->parent = NULL;
                 gCurGraphNodeObject = NULL;
             }
@@ -876,9 +1372,15 @@ static void geo_process_object(struct Object *node) {
  */
 static void geo_process_object_parent(struct GraphNodeObjectParent *node) {
     if (node->sharedChild != NULL) {
+#ifdef THREAD_POOL
+        geo_precompute_objects(node->sharedChild);
+#endif
         node->sharedChild->parent = (struct GraphNode *) node;
         geo_process_node_and_siblings(node->sharedChild);
         node->sharedChild->parent = NULL;
+#ifdef THREAD_POOL
+        sPrecomputedCount = 0;
+#endif
     }
     if (node->node.children != NULL) {
         geo_process_node_and_siblings(node->node.children);
@@ -964,10 +1466,48 @@ void geo_try_process_children(struct GraphNode *node) {
  * The first argument is the start node, and all its siblings will
  * be iterated over.
  */
+#ifdef MEMORY_STATS
+static struct GraphNode *sLastOverflowNode;
+static u32 sReportedOverflows;
+
+static u32 geo_display_list_overflows(void) {
+    return gDisplayListPoolStats.overflows + gDisplayListPoolStats.listNodeOverflows
+           + gDisplayListPoolStats.failedAllocs;
+}
+
+/**
+ * Print the node that made the display list pools overflow, once the innermost node that was
+ * processing at the time is done. A node that keeps overflowing is only named once in a row.
+ */
+static void geo_report_display_list_overflow(struct GraphNode *node, u32 overflowsBefore) {
+    u32 overflows = geo_display_list_overflows();
+    struct Object *obj;
+
+    if (overflows == overflowsBefore || overflows == sReportedOverflows) {
+        return;
+    }
+    sReportedOverflows = overflows;
+    if (node == sLastOverflowNode) {
+        return;
+    }
+    sLastOverflowNode = node;
+
+    obj = node->type == GRAPH_NODE_TYPE_OBJECT ? (struct Object *) node : (struct Object *) gCurGraphNodeObject;
+    fprintf(stderr, "display list pool overflow in geo node %p of type 0x%03x", (void *) node, node->type);
+    if (obj != NULL) {
+        fprintf(stderr, ", object with behavior %p", (const void *) obj->behavior);
+    }
+    fprintf(stderr, " (level %d, area %d)\n", gCurrLevelNum, gCurrAreaIndex);
+}
+#endif
+
 void geo_process_node_and_siblings(struct GraphNode *firstNode) {
     s16 iterateChildren = TRUE;
     struct GraphNode *curGraphNode = firstNode;
     struct GraphNode *parent = curGraphNode->parent;
+#ifdef MEMORY_STATS
+    u32 overflowsBefore;
+#endif
 
     // In the case of a switch node, exactly one of the children of the node is
     // processed instead of all children like usual
@@ -976,6 +1516,9 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
     }
 
     do {
+#ifdef MEMORY_STATS
+        overflowsBefore = geo_display_list_overflows();
+#endif
         if (curGraphNode->flags & GRAPH_RENDER_ACTIVE) {
             if (curGraphNode->flags & GRAPH_RENDER_CHILDREN_FIRST) {
                 geo_try_process_children(curGraphNode);
@@ -1049,6 +1592,9 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
                 ((struct GraphNodeObject *) curGraphNode)->throwMatrix = NULL;
             }
         }
+#ifdef MEMORY_STATS
+        geo_report_display_list_overflow(curGraphNode, overflowsBefore);
+#endif
     } while (iterateChildren && (curGraphNode = curGraphNode->next) != firstNode);
 }
 
@@ -1092,6 +1638,10 @@ void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor)
         if (node->node.children != NULL) {
             geo_process_node_and_siblings(node->node.children);
         }
+#ifndef TARGET_N64
+        // Leave the usual room for the HUD and the rest of the frame
+        display_list_pool_check();
+#endif
         gCurGraphNodeRoot = NULL;
         if (gShowDebugText) {
             print_text_fmt_int(180, 36, "MEM %d",
@@ -29,5 +29,10 @@ extern u16 gAreaUpdateCounter;
 
 void geo_process_node_and_siblings(struct GraphNode *firstNode);
 void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor);
+#ifndef TARGET_N64
+extern s8 gGeoSkipDisplayLists;
+
+void geo_process_savestate_exclude(void (*exclude)(void *addr, u32 size));
+#endif
 
 #endif // RENDERING_GRAPH_NODE_H
@@ -112,11 +112,226 @@ void unused_deallocate(struct LinkedList *freeList, struct LinkedList *node) {
     node->next = freeList->next;
     freeList->next = node;
 }
+#ifndef TARGET_N64
+/**
+ * Per-behavior index of the objects in the object lists, so that queries like
+ * count_objects_with_behavior only visit the objects with that behavior.
+ * Each behavior gets a slot in an open addressed hash table, holding a doubly
+ * linked list of pool indices. The lists are kept in object list order, which
+ * is allocation order, so queries find objects in the same order as a scan.
+ */
+#define BEHAVIOR_INDEX_SIZE 1024 // Power of two, above the number of behavior scripts
+#define BEHAVIOR_INDEX_NONE -1
+
+struct BehaviorIndexEntry {
+    const BehaviorScript *behavior;
+    s16 head;
+    s16 tail;
+};
+
+static struct BehaviorIndexEntry sBehaviorIndex[BEHAVIOR_INDEX_SIZE];
+static s16 sBehaviorIndexUsed;
+
+// Per pool slot: list links, the entry it's in, its object list, and its allocation order
+static s16 sBhvNext[OBJECT_POOL_CAPACITY];
+static s16 sBhvPrev[OBJECT_POOL_CAPACITY];
+static struct BehaviorIndexEntry *sBhvEntry[OBJECT_POOL_CAPACITY];
+static u8 sBhvObjList[OBJECT_POOL_CAPACITY];
+static u32 sBhvSeq[OBJECT_POOL_CAPACITY];
+static u32 sBhvNextSeq;
+
+// Set if the table ever fills up, in which case lookups fall back to scanning the object lists
+static u8 sBehaviorIndexFull;
+
+static void behavior_index_reset(void) {
+    s32 i;
+
+    for (i = 0; i < BEHAVIOR_INDEX_SIZE; i++) {
+        sBehaviorIndex[i].behavior = NULL;
+    }
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        sBhvEntry[i] = NULL;
+    }
+    sBehaviorIndexUsed = 0;
+    sBehaviorIndexFull = FALSE;
+    sBhvNextSeq = 0;
+}
+
+/**
+ * Return the table entry for behavior, adding it if add is set. Return NULL if
+ * there is none (or no room for it).
+ */
+static struct BehaviorIndexEntry *behavior_index_lookup(const BehaviorScript *behavior, s32 add) {
+    u32 i = (((u32) ((uintptr_t) behavior >> 2) * 2654435761u) >> 16) & (BEHAVIOR_INDEX_SIZE - 1);
+
+    while (sBehaviorIndex[i].behavior != NULL) {
+        if (sBehaviorIndex[i].behavior == behavior) {
+            return &sBehaviorIndex[i];
+        }
+        i = (i + 1) & (BEHAVIOR_INDEX_SIZE - 1);
+    }
+
+    // Keep at least one empty slot so that the probe above always ends
+    if (!add || sBehaviorIndexUsed == BEHAVIOR_INDEX_SIZE - 1) {
+        return NULL;
+    }
+    sBehaviorIndexUsed++;
+    sBehaviorIndex[i].behavior = behavior;
+    sBehaviorIndex[i].head = BEHAVIOR_INDEX_NONE;
+    sBehaviorIndex[i].tail = BEHAVIOR_INDEX_NONE;
+    return &sBehaviorIndex[i];
+}
+
+/**
+ * Add obj to the list of its current behavior, before any object that was
+ * allocated after it.
+ */
+static void behavior_index_insert(struct Object *obj) {
+    s16 slot = obj - gObjectPool;
+    struct BehaviorIndexEntry *entry = behavior_index_lookup(obj->behavior, TRUE);
+    s16 prev;
+
+    if (entry == NULL) {
+        sBehaviorIndexFull = TRUE;
+        return;
+    }
+
+    // Objects are normally added as they're created, so this stops right away
+    prev = entry->tail;
+    while (prev != BEHAVIOR_INDEX_NONE && sBhvSeq[prev] > sBhvSeq[slot]) {
+        prev = sBhvPrev[prev];
+    }
+
+    sBhvPrev[slot] = prev;
+    if (prev == BEHAVIOR_INDEX_NONE) {
+        sBhvNext[slot] = entry->head;
+        entry->head = slot;
+    } else {
+        sBhvNext[slot] = sBhvNext[prev];
+        sBhvNext[prev] = slot;
+    }
+    if (sBhvNext[slot] == BEHAVIOR_INDEX_NONE) {
+        entry->tail = slot;
+    } else {
+        sBhvPrev[sBhvNext[slot]] = slot;
+    }
+    sBhvEntry[slot] = entry;
+}
+
+static void behavior_index_remove(struct Object *obj) {
+    s16 slot = obj - gObjectPool;
+    struct BehaviorIndexEntry *entry;
+
+    if ((entry = sBhvEntry[slot]) == NULL) {
+        return;
+    }
+
+    if (sBhvPrev[slot] == BEHAVIOR_INDEX_NONE) {
+        entry->head = sBhvNext[slot];
+    } else {
+        sBhvNext[sBhvPrev[slot]] = sBhvNext[slot];
+    }
+    if (sBhvNext[slot] == BEHAVIOR_INDEX_NONE) {
+        entry->tail = sBhvPrev[slot];
+    } else {
+        sBhvPrev[sBhvNext[slot]] = sBhvPrev[slot];
+    }
+    sBhvEntry[slot] = NULL;
+}
+
+/**
+ * Add a newly created object to the index, in the given object list.
+ */
+static void behavior_index_add(struct Object *obj, s32 objList) {
+    s16 slot = obj - gObjectPool;
+
+    sBhvObjList[slot] = objList;
+    sBhvSeq[slot] = sBhvNextSeq++;
+    behavior_index_insert(obj);
+}
+
+/**
+ * Move obj to the list of its current behavior, after obj->behavior was changed.
+ */
+void behavior_index_update(struct Object *obj) {
+    s16 slot = obj - gObjectPool;
+
+    if (sBhvEntry[slot] != NULL && sBhvEntry[slot]->behavior != obj->behavior) {
+        behavior_index_remove(obj);
+        behavior_index_insert(obj);
+    }
+}
+
+/**
+ * Starting at obj, return the first object in object list objList with the given
+ * behavior, or NULL. Only used if the index is full.
+ */
+static struct Object *behavior_index_scan(struct Object *obj, const BehaviorScript *behavior, u32 objList) {
+    while (obj != (struct Object *) &gObjectLists[objList]) {
+        if (obj->behavior == behavior) {
+            return obj;
+        }
+        obj = (struct Object *) obj->header.next;
+    }
+    return NULL;
+}
+
+/**
+ * Return the first object in object list objList with the given behavior (a
+ * virtual address), or NULL if there is none. Together with behavior_index_next,
+ * this visits the same objects in the same order as a scan of the object list
+ * comparing obj->behavior.
+ */
+struct Object *behavior_index_first(const BehaviorScript *behavior, u32 objList) {
+    struct BehaviorIndexEntry *entry;
+    s16 slot;
+
+    if (sBehaviorIndexFull) {
+        return behavior_index_scan((struct Object *) gObjectLists[objList].next, behavior, objList);
+    }
+
+    entry = behavior_index_lookup(behavior, FALSE);
+    if (entry == NULL) {
+        return NULL;
+    }
+    for (slot = entry->head; slot != BEHAVIOR_INDEX_NONE; slot = sBhvNext[slot]) {
+        if (sBhvObjList[slot] == objList) {
+            return &gObjectPool[slot];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Return the next object after obj with the same behavior in the same object
+ * list, or NULL.
+ */
+struct Object *behavior_index_next(struct Object *obj) {
+    s16 slot = obj - gObjectPool;
+    u8 objList = sBhvObjList[slot];
+
+    if (sBehaviorIndexFull) {
+        return behavior_index_scan((struct Object *) obj->header.next, obj->behavior, objList);
+    }
+
+    for (slot = sBhvNext[slot]; slot != BEHAVIOR_INDEX_NONE; slot = sBhvNext[slot]) {
+        if (sBhvObjList[slot] == objList) {
+            return &gObjectPool[slot];
+        }
+    }
+    return NULL;
+}
+#endif
+
 /**
  * Remove the given object from the object list that it's currently in, and
  * insert it at the beginning of the free list (singly linked).
  */
 static void deallocate_object(struct ObjectNode *freeList, struct ObjectNode *obj) {
+#ifndef TARGET_N64
+    behavior_index_remove((struct Object *) obj);
+#endif
+
     // Remove from object list
     obj->next->prev = obj->prev;
     obj->prev->next = obj->next;
@@ -157,6 +372,10 @@ void clear_object_lists(struct ObjectNode *objLists) {
         objLists[i].next = &objLists[i];
         objLists[i].prev = &objLists[i];
     }
+
+#ifndef TARGET_N64
+    behavior_index_reset();
+#endif
 }
 
 /**
@@ -191,8 +410,12 @@ void unload_object(struct Object *obj) {
 
     obj->header.gfx.throwMatrix = NULL;
     func_803206F8(obj->header.gfx.cameraToObject);
+#ifndef TARGET_N64
+    geo_detach_object_node(&obj->header.gfx);
+#else
     geo_remove_child(&obj->header.gfx.node);
     geo_add_child(&gObjParentGraphNode, &obj->header.gfx.node);
+#endif
 
     obj->header.gfx.node.flags &= ~GRAPH_RENDER_BILLBOARD;
     obj->header.gfx.node.flags &= ~GRAPH_RENDER_ACTIVE;
@@ -329,6 +552,9 @@ struct Object *create_object(const BehaviorScript *bhvScript) {
 
     obj->curBhvCommand = bhvScript;
     obj->behavior = behavior;
+#ifndef TARGET_N64
+    behavior_index_add(obj, objListIndex);
+#endif
 
     if (objListIndex == OBJ_LIST_UNIMPORTANT) {
         obj->activeFlags |= ACTIVE_FLAG_UNIMPORTANT;
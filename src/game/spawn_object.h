@@ -8,5 +8,10 @@ void clear_object_lists(struct ObjectNode *objLists);
 void unload_object(struct Object *obj);
 struct Object *create_object(const BehaviorScript *bhvScript);
 void mark_obj_for_deletion(struct Object *obj);
+#ifndef TARGET_N64
+void behavior_index_update(struct Object *obj);
+struct Object *behavior_index_first(const BehaviorScript *behavior, u32 objList);
+struct Object *behavior_index_next(struct Object *obj);
+#endif
 
 #endif // SPAWN_OBJECT_H
@@ -1,6 +1,9 @@
 #include <ultra64.h>
 #include <stdarg.h>
 #include <stdio.h>
+#ifndef TARGET_N64
+#include <string.h>
+#endif
 
 #ifndef VERSION_EU
 #include "prevent_bss_reordering.h"
@@ -151,6 +154,21 @@ static struct GdColour sLightScaleColours[2]; // @ 801BB1A0
 static struct LightDirVec sLightDirections[2];
 static s32 sLightId;
 static Hilite sHilites[600];
+#ifndef TARGET_N64
+// What each material's display list was last written with, see mtl_dl_is_current()
+struct MtlDlInputs {
+    s32 material;
+    s32 numLights;
+    struct GdColour colour;
+    struct GdColour ambScaleColour;
+    struct GdColour lightScaleColours[2];
+    struct LightDirVec lightDirections[2];
+    s32 hiliteX; // position of a shiny material's hilite, which its list copies
+    s32 hiliteY;
+};
+static struct MtlDlInputs sMtlDlInputs[MAX_GD_DLS];
+static u8 sMtlDlWritten[MAX_GD_DLS];
+#endif
 static struct GdVec3f D_801BD758;
 static struct GdVec3f D_801BD768; // had to migrate earlier
 static u32 D_801BD774;
@@ -1412,6 +1430,9 @@ struct GdDisplayList *alloc_displaylist(u32 id) {
     }
     sGdDLArray[gdDl->number] = gdDl;
     gdDl->id = id;
+#ifndef TARGET_N64
+    sMtlDlWritten[gdDl->number] = FALSE;
+#endif
     return gdDl;
 }
 
@@ -2052,6 +2073,37 @@ void func_801A0478(s32 idx, // material GdDl number; offsets into hilite array
     }
 }
 
+#ifndef TARGET_N64
+/**
+ * Returns whether material display list `id` already holds what `func_801A086C()` would
+ * write into it for these inputs, and records them if not. The Mario head rewrites all of
+ * its materials every frame, while their colours and lights rarely change. A shiny
+ * material's list holds its hilite's position, which follows the camera.
+ */
+static s32 mtl_dl_is_current(s32 id, struct GdColour *colour, s32 material) {
+    struct MtlDlInputs inputs;
+
+    memset(&inputs, 0, sizeof(inputs));
+    inputs.material = material;
+    inputs.numLights = sNumLights;
+    inputs.colour = *colour;
+    inputs.ambScaleColour = sAmbScaleColour;
+    memcpy(inputs.lightScaleColours, sLightScaleColours, sizeof(sLightScaleColours));
+    memcpy(inputs.lightDirections, sLightDirections, sizeof(sLightDirections));
+    if (material == GD_MTL_SHINE_DL && id < ARRAY_COUNT(sHilites)) {
+        inputs.hiliteX = sHilites[id].h.x1;
+        inputs.hiliteY = sHilites[id].h.y1;
+    }
+
+    if (sMtlDlWritten[id] && memcmp(&sMtlDlInputs[id], &inputs, sizeof(inputs)) == 0) {
+        return TRUE;
+    }
+    sMtlDlInputs[id] = inputs;
+    sMtlDlWritten[id] = TRUE;
+    return FALSE;
+}
+#endif
+
 /* 24F03C -> 24FDB8 */
 s32 func_801A086C(s32 id, struct GdColour *colour, s32 material) {
     UNUSED u32 pad60[2];
@@ -2060,6 +2112,11 @@ s32 func_801A086C(s32 id, struct GdColour *colour, s32 material) {
     s32 scaledColours[3];
     s32 lightDir[3];
 
+#ifndef TARGET_N64
+    if (id > 0 && mtl_dl_is_current(id, colour, material)) {
+        return 0;
+    }
+#endif
     if (id > 0) {
         reset_dlnum_indices(id);
     }
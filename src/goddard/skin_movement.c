@@ -9,6 +9,29 @@
 #include "skin.h"
 #include "skin_movement.h"
 
+// Outside of N64 builds, the joint weights are applied with SSE2 or NEON, a whole vertex at a
+// time. The head's skin is a few hundred weighted vertices that move every frame.
+#if !defined(TARGET_N64) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define SKIN_SIMD
+#endif
+#if defined(SKIN_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128 SkinVec;
+#define skin_load(src) _mm_loadu_ps(src)
+#define skin_splat(x) _mm_set1_ps(x)
+#define skin_add(a, b) _mm_add_ps(a, b)
+#define skin_mul(a, b) _mm_mul_ps(a, b)
+#define skin_store(dest, v) _mm_storeu_ps(dest, v)
+#elif defined(SKIN_SIMD)
+#include <arm_neon.h>
+typedef float32x4_t SkinVec;
+#define skin_load(src) vld1q_f32(src)
+#define skin_splat(x) vdupq_n_f32(x)
+#define skin_add(a, b) vaddq_f32(a, b)
+#define skin_mul(a, b) vmulq_f32(a, b)
+#define skin_store(dest, v) vst1q_f32(dest, v)
+#endif
+
 /* bss */
 struct ObjWeight *sSkinNetCurWeight;
 static Mat4f D_801B9EA8; // TODO: rename to sHead2Mtx?
@@ -76,14 +99,51 @@ void move_skin(struct ObjNet *net) {
 /* @ 230064 for 0x13C*/
 void func_80181894(struct ObjJoint *joint) {
     register struct ObjGroup *weightGroup; // baseGroup? weights Only?
+#ifndef SKIN_SIMD
     struct GdVec3f stackVec;
+#endif
     register struct ObjWeight *curWeight;
     register struct ObjVertex *connectedVtx;
     register struct Links *link;
     register f32 scaleFactor;
     struct GdObj *linkedObj;
 
+#ifdef SKIN_SIMD
+    SkinVec row0, row1, row2, row3, v;
+    f32 sum[4];
+#endif
+
     weightGroup = joint->unk1F4;
+#ifdef SKIN_SIMD
+    // The same multiplies and adds as gd_rotate_and_translate_vec3f and the scaling below, in the
+    // same order, so the vertices come out the same as with the scalar code.
+    if (weightGroup != NULL) {
+        row0 = skin_load(joint->matE8[0]);
+        row1 = skin_load(joint->matE8[1]);
+        row2 = skin_load(joint->matE8[2]);
+        row3 = skin_load(joint->matE8[3]);
+        for (link = weightGroup->link1C; link != NULL; link = link->next) {
+            linkedObj = link->obj;
+            curWeight = (struct ObjWeight *) linkedObj;
+
+            if (curWeight->unk38 > 0.0) {
+                connectedVtx = curWeight->unk3C;
+                scaleFactor = curWeight->unk38;
+
+                v = skin_add(skin_mul(row0, skin_splat(curWeight->vec20.x)),
+                             skin_mul(row1, skin_splat(curWeight->vec20.y)));
+                v = skin_add(v, skin_mul(row2, skin_splat(curWeight->vec20.z)));
+                v = skin_add(v, row3);
+                // pos is followed by the normal, so only its 3 components are written back
+                v = skin_add(skin_load(&connectedVtx->pos.x), skin_mul(v, skin_splat(scaleFactor)));
+                skin_store(sum, v);
+                connectedVtx->pos.x = sum[0];
+                connectedVtx->pos.y = sum[1];
+                connectedVtx->pos.z = sum[2];
+            }
+        }
+    }
+#else
     if (weightGroup != NULL) {
         for (link = weightGroup->link1C; link != NULL; link = link->next) {
             linkedObj = link->obj;
@@ -105,6 +165,7 @@ void func_80181894(struct ObjJoint *joint) {
             }
         }
     }
+#endif
 }
 
 /* @ 2301A0 for 0x110 */
@@ -5,6 +5,21 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// The game always synthesizes at this rate. If configAudioOutputRate differs, pc_main
+// resamples each buffer before play(), so backends should open the device at the output rate.
+#define AUDIO_SYNTHESIS_RATE 32000
+
+// Converts a frame count at the synthesis rate to one at the output rate.
+#define AUDIO_OUTPUT_FRAMES(frames) ((int) ((long long) (frames) * configAudioOutputRate / AUDIO_SYNTHESIS_RATE))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern unsigned int configAudioOutputRate;
+#ifdef __cplusplus
+}
+#endif
+
 struct AudioAPI {
     bool (*init)(void);
     int (*buffered)(void);
@@ -0,0 +1,111 @@
+#include <math.h>
+#include <string.h>
+
+#include "audio_api.h"
+#include "audio_buffering.h"
+
+// Gains of the PI controller, per buffer. The proportional term closes a few percent of the
+// queue error every buffer; the integral term slowly learns the device's clock drift.
+#define KP 0.05f
+#define KI 0.002f
+
+// Bound on the learned drift, in samples per buffer, so a stalled device can't wind it up.
+#define MAX_DRIFT 32.0f
+
+static struct {
+    uint32_t latencyMs;
+    float targetFrames;  // Target queue depth, in output frames
+    float framesToSamples;
+    float nominalSamples;
+    float carry;         // Quantization residue carried over to the next buffer
+    uint32_t minSamples;
+    uint32_t maxSamples;
+    bool started;
+} sController;
+
+static struct AudioBufferingStats sStats;
+
+void audio_buffering_init(uint32_t latencyMs, uint32_t outputRate, float nominalSamples,
+                          uint32_t minSamples, uint32_t maxSamples) {
+    memset(&sController, 0, sizeof(sController));
+    sController.latencyMs = latencyMs;
+    sController.targetFrames = (float) latencyMs * outputRate / 1000.0f;
+    sController.framesToSamples = (float) AUDIO_SYNTHESIS_RATE / outputRate;
+    sController.nominalSamples = nominalSamples;
+    sController.minSamples = minSamples;
+    sController.maxSamples = maxSamples;
+    audio_buffering_reset_stats();
+}
+
+static void update_stats(int bufferedFrames) {
+    if (sController.started && bufferedFrames == 0) {
+        sStats.underruns++;
+    }
+    if (bufferedFrames > 0) {
+        sController.started = true;
+    }
+    sStats.buffered = bufferedFrames;
+    if (bufferedFrames < sStats.bufferedMin) {
+        sStats.bufferedMin = bufferedFrames;
+    }
+    if (bufferedFrames > sStats.bufferedMax) {
+        sStats.bufferedMax = bufferedFrames;
+    }
+    sStats.latencyMs = bufferedFrames * sController.framesToSamples * 1000.0f / AUDIO_SYNTHESIS_RATE;
+}
+
+uint32_t audio_buffering_next_samples(int bufferedFrames, int desiredFrames) {
+    float error;
+    float wanted;
+    float quantized;
+
+    update_stats(bufferedFrames);
+
+    if (sController.latencyMs == 0) {
+        sStats.lastSamples = bufferedFrames < desiredFrames ? sController.maxSamples - AUDIO_BUFFERING_GRANULARITY
+                                                            : sController.minSamples + AUDIO_BUFFERING_GRANULARITY;
+        return sStats.lastSamples;
+    }
+
+    // Queue error, converted to synthesis samples
+    error = (sController.targetFrames - bufferedFrames) * sController.framesToSamples;
+
+    sStats.drift += KI * error;
+    if (sStats.drift > MAX_DRIFT) {
+        sStats.drift = MAX_DRIFT;
+    } else if (sStats.drift < -MAX_DRIFT) {
+        sStats.drift = -MAX_DRIFT;
+    }
+
+    wanted = sController.nominalSamples + KP * error + sStats.drift + sController.carry;
+
+    // Synthesis works in multiples of AUDIO_BUFFERING_GRANULARITY samples. Carry the rounding
+    // error over, so the average over several buffers is exactly what the controller asked for.
+    quantized = floorf(wanted / AUDIO_BUFFERING_GRANULARITY + 0.5f) * AUDIO_BUFFERING_GRANULARITY;
+    if (quantized < sController.minSamples) {
+        quantized = sController.minSamples;
+    } else if (quantized > sController.maxSamples) {
+        quantized = sController.maxSamples;
+    }
+    sController.carry = wanted - quantized;
+    if (sController.carry > AUDIO_BUFFERING_GRANULARITY) {
+        sController.carry = AUDIO_BUFFERING_GRANULARITY;
+    } else if (sController.carry < -AUDIO_BUFFERING_GRANULARITY) {
+        sController.carry = -AUDIO_BUFFERING_GRANULARITY;
+    }
+
+    sStats.lastSamples = (uint32_t) quantized;
+    return sStats.lastSamples;
+}
+
+const struct AudioBufferingStats *audio_buffering_get_stats(void) {
+    return &sStats;
+}
+
+void audio_buffering_reset_stats(void) {
+    float drift = sStats.drift;
+
+    memset(&sStats, 0, sizeof(sStats));
+    sStats.bufferedMin = INT32_MAX;
+    sStats.drift = drift;
+}
@@ -0,0 +1,36 @@
+#ifndef AUDIO_BUFFERING_H
+#define AUDIO_BUFFERING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Decides how many samples to synthesize per audio buffer so that the amount queued in
+// the audio device stays at a target latency. With a latency target of 0 the legacy
+// heuristic is used (high or low sample count depending on get_desired_buffered()).
+
+// Synthesis needs the sample count to be a multiple of 16 per buffer.
+#define AUDIO_BUFFERING_GRANULARITY 16
+
+struct AudioBufferingStats {
+    uint32_t underruns;       // Times the device was found empty after playback started
+    int32_t buffered;         // Frames queued in the device at the last update
+    int32_t bufferedMin;      // Lowest queue depth since the last reset
+    int32_t bufferedMax;      // Highest queue depth since the last reset
+    float latencyMs;          // Estimated output latency from the queue depth
+    float drift;              // Integral term, i.e. the learned device clock drift in samples per buffer
+    uint32_t lastSamples;     // Samples chosen for the last buffer
+};
+
+// latencyMs: target queue depth (0 for the legacy heuristic). outputRate: rate buffered() is in.
+// nominalSamples: synthesis rate divided by buffers per second.
+// minSamples/maxSamples: the range of sample counts per buffer the caller can synthesize.
+void audio_buffering_init(uint32_t latencyMs, uint32_t outputRate, float nominalSamples,
+                          uint32_t minSamples, uint32_t maxSamples);
+
+// Returns the number of samples to synthesize for the next buffer.
+uint32_t audio_buffering_next_samples(int bufferedFrames, int desiredFrames);
+
+const struct AudioBufferingStats *audio_buffering_get_stats(void);
+void audio_buffering_reset_stats(void);
+
+#endif
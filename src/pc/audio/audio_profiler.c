@@ -0,0 +1,43 @@
+#include "audio_profiler.h"
+
+// If the profiler is disabled, this file is empty.
+#ifdef AUDIO_PROFILER
+
+#include <string.h>
+
+#include "pc/timer.h"
+
+struct AudioProfilerStageStats gAudioProfilerStats[AUDIO_PROFILER_STAGE_COUNT];
+
+static const char *sStageNames[AUDIO_PROFILER_STAGE_COUNT] = {
+    "process_notes",
+    "synthesis_process_notes",
+    "mixer adpcm",
+    "mixer resample",
+    "mixer envmixer",
+    "mixer mix",
+    "mixer other",
+    "reverb",
+};
+
+u64 audio_profiler_now_ns(void) {
+    return timer_now_ns();
+}
+
+void audio_profiler_add(s32 stage, u64 startNs) {
+    gAudioProfilerStats[stage].totalNs += audio_profiler_now_ns() - startNs;
+    gAudioProfilerStats[stage].calls++;
+}
+
+void audio_profiler_reset(void) {
+    memset(gAudioProfilerStats, 0, sizeof(gAudioProfilerStats));
+}
+
+const char *audio_profiler_stage_name(s32 stage) {
+    if (stage < 0 || stage >= AUDIO_PROFILER_STAGE_COUNT) {
+        return "unknown";
+    }
+    return sStageNames[stage];
+}
+
+#endif // AUDIO_PROFILER
@@ -0,0 +1,55 @@
+#ifndef AUDIO_PROFILER_H
+#define AUDIO_PROFILER_H
+
+#include <types.h>
+
+// Wall-clock timing of the individual audio synthesis stages.
+// Enable by building with ENABLE_AUDIO_PROFILER=1. This file is ignored completely on N64.
+
+enum AudioProfilerStage {
+    AUDIO_PROFILER_PROCESS_NOTES,           // process_notes() in playback.c
+    AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES, // synthesis_process_notes(), including the mixer ops it issues
+    AUDIO_PROFILER_MIXER_ADPCM,             // aLoadADPCM, aADPCMdec, aSetLoop
+    AUDIO_PROFILER_MIXER_RESAMPLE,          // aResample
+    AUDIO_PROFILER_MIXER_ENVMIXER,          // aEnvMixer, aSetVolume
+    AUDIO_PROFILER_MIXER_MIX,               // aMix
+    AUDIO_PROFILER_MIXER_OTHER,             // Buffer loads, saves, moves, clears and interleaves
+    AUDIO_PROFILER_REVERB,                  // Reverb ring buffer updates, including the mixer ops they issue
+    AUDIO_PROFILER_STAGE_COUNT
+};
+
+struct AudioProfilerStageStats {
+    u64 totalNs;
+    u32 calls;
+};
+
+#ifdef AUDIO_PROFILER
+
+extern struct AudioProfilerStageStats gAudioProfilerStats[AUDIO_PROFILER_STAGE_COUNT];
+
+u64 audio_profiler_now_ns(void); // Monotonic timestamp in nanoseconds.
+void audio_profiler_add(s32 stage, u64 startNs); // Adds the time elapsed since startNs to a stage.
+void audio_profiler_reset(void); // Clears all accumulated stage times.
+const char *audio_profiler_stage_name(s32 stage);
+
+// Times a single statement and accumulates it into the given stage.
+#define AUDIO_PROFILER_WRAP(stage, call)                                                               \
+    do {                                                                                               \
+        u64 audioProfilerStart = audio_profiler_now_ns();                                              \
+        call;                                                                                          \
+        audio_profiler_add(stage, audioProfilerStart);                                                 \
+    } while (0)
+
+// Times a region of statements within one block.
+#define AUDIO_PROFILER_BEGIN(name) u64 name = audio_profiler_now_ns()
+#define AUDIO_PROFILER_END(stage, name) audio_profiler_add(stage, name)
+
+#else
+
+#define AUDIO_PROFILER_WRAP(stage, call) call
+#define AUDIO_PROFILER_BEGIN(name)
+#define AUDIO_PROFILER_END(stage, name)
+
+#endif // AUDIO_PROFILER
+
+#endif // AUDIO_PROFILER_H
@@ -77,14 +77,14 @@ static bool audio_pulse_init(void) {
     // Create stream
     pa_sample_spec ss;
     ss.format = PA_SAMPLE_S16LE;
-    ss.rate = 32000;
+    ss.rate = configAudioOutputRate;
     ss.channels = 2;
     
     pa_buffer_attr attr;
-    attr.maxlength = (1600 + 544 + 528 + 1600) * 4;
-    attr.tlength = (528*2 + 544) * 4;
-    attr.prebuf = 1500 * 4;
-    attr.minreq = 161 * 4;
+    attr.maxlength = AUDIO_OUTPUT_FRAMES(1600 + 544 + 528 + 1600) * 4;
+    attr.tlength = AUDIO_OUTPUT_FRAMES(528*2 + 544) * 4;
+    attr.prebuf = AUDIO_OUTPUT_FRAMES(1500) * 4;
+    attr.minreq = AUDIO_OUTPUT_FRAMES(161) * 4;
     attr.fragsize = (uint32_t)-1;
     
     pas.stream = pa_stream_new(pas.context, "mario", &ss, NULL);
@@ -171,7 +171,7 @@ static int audio_pulse_buffered(void) {
 }
 
 static int audio_pulse_get_desired_buffered(void) {
-    return 1100;
+    return AUDIO_OUTPUT_FRAMES(1100);
 }
 
 static void audio_pulse_play(const uint8_t *buf, size_t len) {
@@ -0,0 +1,147 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_resampler.h"
+
+#define HISTORY_FRAMES (AUDIO_RESAMPLER_TAPS - 1)
+
+// Larger ratios (e.g. 32000 -> 44100 has 441 branches) are fine; this only guards against
+// nonsense rates producing a huge filter bank.
+#define MAX_BRANCHES 1024
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Designs a Blackman-windowed sinc low-pass filter at the upsampled rate and splits it
+// into 'up' branches, so that each output sample only needs AUDIO_RESAMPLER_TAPS taps.
+static void design_filter(struct AudioResampler *resampler) {
+    uint32_t up = resampler->up;
+    uint32_t length = up * AUDIO_RESAMPLER_TAPS;
+    uint32_t max = up > resampler->down ? up : resampler->down;
+    // Cutoff in cycles per upsampled sample, slightly below Nyquist for the transition band
+    double cutoff = 0.5 / max * 0.92;
+    double center = (length - 1) / 2.0;
+    double sum = 0.0;
+    double *proto = malloc(length * sizeof(double));
+    uint32_t i;
+
+    for (i = 0; i < length; i++) {
+        double x = i - center;
+        double sinc = x == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * i / (length - 1))
+                        + 0.08 * cos(4.0 * M_PI * i / (length - 1));
+        proto[i] = sinc * window;
+        sum += proto[i];
+    }
+
+    // Each branch sees every up'th coefficient, so normalize the total gain to 'up'.
+    for (i = 0; i < length; i++) {
+        uint32_t branch = i % up;
+        uint32_t tap = i / up;
+        resampler->coeffs[branch * AUDIO_RESAMPLER_TAPS + tap] = proto[i] * up / sum;
+    }
+    free(proto);
+}
+
+bool audio_resampler_init(struct AudioResampler *resampler, uint32_t inRate, uint32_t outRate) {
+    uint32_t div;
+
+    memset(resampler, 0, sizeof(*resampler));
+    if (inRate == 0 || outRate == 0) {
+        return false;
+    }
+    div = gcd(inRate, outRate);
+    resampler->up = outRate / div;
+    resampler->down = inRate / div;
+    if (resampler->up > MAX_BRANCHES || resampler->down > MAX_BRANCHES * 4) {
+        return false;
+    }
+
+    resampler->coeffs = malloc(resampler->up * AUDIO_RESAMPLER_TAPS * sizeof(float));
+    if (resampler->coeffs == NULL) {
+        return false;
+    }
+    design_filter(resampler);
+    return true;
+}
+
+void audio_resampler_free(struct AudioResampler *resampler) {
+    free(resampler->coeffs);
+    free(resampler->history);
+    free(resampler->out);
+    memset(resampler, 0, sizeof(*resampler));
+}
+
+static inline int16_t clamp16(float value) {
+    if (value >= 32767.0f) {
+        return 32767;
+    }
+    if (value <= -32768.0f) {
+        return -32768;
+    }
+    return (int16_t) lrintf(value);
+}
+
+const int16_t *audio_resampler_process(struct AudioResampler *resampler, const int16_t *in, size_t inFrames,
+                                       size_t *outFrames) {
+    size_t needHistory = HISTORY_FRAMES + inFrames;
+    size_t needOut = inFrames * resampler->up / resampler->down + 2;
+    uint32_t up = resampler->up;
+    uint64_t end = (uint64_t) inFrames * up;
+    uint64_t pos = resampler->phase;
+    size_t count = 0;
+
+    if (resampler->historyFrames < needHistory) {
+        int16_t *history = realloc(resampler->history, needHistory * 2 * sizeof(int16_t));
+        if (history == NULL) {
+            *outFrames = 0;
+            return resampler->out;
+        }
+        if (resampler->history == NULL) {
+            memset(history, 0, HISTORY_FRAMES * 2 * sizeof(int16_t));
+        }
+        resampler->history = history;
+        resampler->historyFrames = needHistory;
+    }
+    if (resampler->outFrames < needOut) {
+        int16_t *out = realloc(resampler->out, needOut * 2 * sizeof(int16_t));
+        if (out == NULL) {
+            *outFrames = 0;
+            return resampler->out;
+        }
+        resampler->out = out;
+        resampler->outFrames = needOut;
+    }
+
+    memcpy(resampler->history + HISTORY_FRAMES * 2, in, inFrames * 2 * sizeof(int16_t));
+
+    for (; pos < end && count < resampler->outFrames; pos += resampler->down, count++) {
+        // Newest input frame contributing to this output, and the branch to filter it with
+        const int16_t *src = resampler->history + (HISTORY_FRAMES + pos / up) * 2;
+        const float *coeffs = resampler->coeffs + (pos % up) * AUDIO_RESAMPLER_TAPS;
+        float left = 0.0f;
+        float right = 0.0f;
+        int k;
+
+        for (k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+            left += coeffs[k] * src[-2 * k];
+            right += coeffs[k] * src[-2 * k + 1];
+        }
+        resampler->out[count * 2] = clamp16(left);
+        resampler->out[count * 2 + 1] = clamp16(right);
+    }
+    resampler->phase = pos - end;
+
+    // Keep the tail of this input for the next call
+    memmove(resampler->history, resampler->history + inFrames * 2, HISTORY_FRAMES * 2 * sizeof(int16_t));
+
+    *outFrames = count;
+    return resampler->out;
+}
@@ -0,0 +1,35 @@
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rational polyphase resampler for interleaved stereo s16 audio.
+// Used to convert the game's synthesis rate to the rate the audio device runs at,
+// so the system mixer doesn't have to.
+
+// Number of filter taps per polyphase branch.
+#define AUDIO_RESAMPLER_TAPS 32
+
+struct AudioResampler {
+    uint32_t up;          // Interpolation factor (output rate / gcd)
+    uint32_t down;        // Decimation factor (input rate / gcd)
+    uint32_t phase;       // Position of the next output sample, in 1/up input samples
+    float *coeffs;        // up branches of AUDIO_RESAMPLER_TAPS taps each
+    int16_t *history;     // Last AUDIO_RESAMPLER_TAPS - 1 input frames, followed by the current input
+    size_t historyFrames; // Capacity of history, in frames
+    int16_t *out;
+    size_t outFrames;     // Capacity of out, in frames
+};
+
+// Returns false if the ratio can't be represented with a reasonably sized filter bank.
+bool audio_resampler_init(struct AudioResampler *resampler, uint32_t inRate, uint32_t outRate);
+void audio_resampler_free(struct AudioResampler *resampler);
+
+// Resamples inFrames stereo frames. Returns a buffer owned by the resampler that stays valid
+// until the next call, and stores the number of frames in it to *outFrames.
+const int16_t *audio_resampler_process(struct AudioResampler *resampler, const int16_t *in, size_t inFrames,
+                                       size_t *outFrames);
+
+#endif
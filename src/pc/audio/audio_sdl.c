@@ -17,7 +17,7 @@ static bool audio_sdl_init(void) {
     }
     SDL_AudioSpec want, have;
     SDL_zero(want);
-    want.freq = 32000;
+    want.freq = configAudioOutputRate;
     want.format = AUDIO_S16;
     want.channels = 2;
     want.samples = 512;
@@ -36,11 +36,11 @@ static int audio_sdl_buffered(void) {
 }
 
 static int audio_sdl_get_desired_buffered(void) {
-    return 1100;
+    return AUDIO_OUTPUT_FRAMES(1100);
 }
 
 static void audio_sdl_play(const uint8_t *buf, size_t len) {
-    if (audio_sdl_buffered() < 6000) {
+    if (audio_sdl_buffered() < AUDIO_OUTPUT_FRAMES(6000)) {
         // Don't fill the audio buffer too much in case this happens
         SDL_QueueAudio(dev, buf, len);
     }
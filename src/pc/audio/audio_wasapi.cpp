@@ -123,8 +123,8 @@ static bool audio_wasapi_setup_stream(void) {
         WAVEFORMATEX desired;
         desired.wFormatTag = WAVE_FORMAT_PCM;
         desired.nChannels = 2;
-        desired.nSamplesPerSec = 32000;
-        desired.nAvgBytesPerSec = 32000 * 2 * 2;
+        desired.nSamplesPerSec = configAudioOutputRate;
+        desired.nAvgBytesPerSec = configAudioOutputRate * 2 * 2;
         desired.nBlockAlign = 4;
         desired.wBitsPerSample = 16;
         desired.cbSize = 0;
@@ -161,7 +161,7 @@ static int audio_wasapi_buffered(void) {
 }
 
 static int audio_wasapi_get_desired_buffered(void) {
-    return 1100;
+    return AUDIO_OUTPUT_FRAMES(1100);
 }
 
 //#include <stdio.h>
@@ -191,7 +191,7 @@ static void audio_wasapi_play(const uint8_t *buf, size_t len) {
         memcpy(data, buf, frames * 4);
         ThrowIfFailed(wasapi.rclient->ReleaseBuffer(frames, 0));
 
-        if (!wasapi.started && padding + frames > 1500) {
+        if (!wasapi.started && padding + frames > (UINT32) AUDIO_OUTPUT_FRAMES(1500)) {
             wasapi.started = true;
             ThrowIfFailed(wasapi.client->Start());
         }
@@ -0,0 +1,183 @@
+// audio_render.c - renders a sequence to a WAV file as fast as possible, without a game loop.
+//
+// Built with 'make audio_render'. Links src/audio plus the mixer selected by mixer.c, so it
+// can be used to benchmark mixer changes and to diff audio output without a sound card.
+// Build with ENABLE_AUDIO_PROFILER=1 to get per-stage timings.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "level_table.h"
+
+#include "audio/external.h"
+#include "audio/internal.h"
+#include "audio/load.h"
+#include "audio/data.h"
+#include "audio/heap.h"
+#include "audio/playback.h"
+#include "pc/audio/audio_profiler.h"
+#include "pc/timer.h"
+
+#ifdef VERSION_EU
+#define SAMPLES_HIGH 656
+#define SAMPLES_LOW 640
+#define OUTPUT_FREQUENCY 32000
+#define UPDATES_PER_SECOND 50
+#else
+#define SAMPLES_HIGH 544
+#define SAMPLES_LOW 528
+#define OUTPUT_FREQUENCY 32000
+#define UPDATES_PER_SECOND 60
+#endif
+
+// The game code the audio driver peeks at. Nothing here moves, so the level music
+// dynamics and echo settings stay at their defaults.
+s16 gCurrLevelNum = LEVEL_MIN;
+s16 gCurrAreaIndex = 1;
+s16 gMarioCurrentRoom;
+struct MarioState gMarioStates[1];
+
+extern u16 gSequenceCount;
+
+extern void create_next_audio_buffer(s16 *samples, u32 num_samples);
+
+static void write_u16(FILE *fp, u16 value) {
+    u8 bytes[2] = { value & 0xff, value >> 8 };
+    fwrite(bytes, 1, 2, fp);
+}
+
+static void write_u32(FILE *fp, u32 value) {
+    u8 bytes[4] = { value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, value >> 24 };
+    fwrite(bytes, 1, 4, fp);
+}
+
+static void write_wav_header(FILE *fp, u32 dataSize) {
+    fwrite("RIFF", 1, 4, fp);
+    write_u32(fp, 36 + dataSize);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    write_u32(fp, 16);
+    write_u16(fp, 1); // PCM
+    write_u16(fp, 2); // Stereo
+    write_u32(fp, OUTPUT_FREQUENCY);
+    write_u32(fp, OUTPUT_FREQUENCY * 2 * sizeof(s16));
+    write_u16(fp, 2 * sizeof(s16));
+    write_u16(fp, 16);
+    fwrite("data", 1, 4, fp);
+    write_u32(fp, dataSize);
+}
+
+// Replaces the default bank (the last one loaded) of a sequence's bank set.
+static void override_default_bank(u32 seqId, u8 bankId) {
+    u16 offset = ((u16 *) gAlBankSets)[seqId];
+    u8 count = gAlBankSets[offset];
+
+    if (count != 0) {
+        gAlBankSets[offset + count] = bankId;
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s <seq id> <out.wav> [seconds] [bank id] [session preset] [max notes] [full rate reverb]\n", name);
+}
+
+int main(int argc, char *argv[]) {
+    static s16 buffer[SAMPLES_HIGH * 2];
+    u32 seqId, seconds = 60, preset = 0;
+    s32 bankId = -1;
+    u32 frames, frame, written = 0;
+    u64 expected = 0, start, elapsed;
+    FILE *fp;
+    s32 i;
+
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    seqId = strtoul(argv[1], NULL, 0);
+    if (argc > 3) {
+        seconds = strtoul(argv[3], NULL, 0);
+    }
+    if (argc > 4) {
+        bankId = strtol(argv[4], NULL, 0);
+    }
+    if (argc > 5) {
+        preset = strtoul(argv[5], NULL, 0);
+    }
+    if (argc > 6) {
+        gAudioMaxNotes = strtol(argv[6], NULL, 0);
+    }
+    if (argc > 7) {
+        gAudioReverbFullRate = strtol(argv[7], NULL, 0) != 0;
+    }
+
+    fp = fopen(argv[2], "wb");
+    if (fp == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+    write_wav_header(fp, 0);
+
+    audio_init();
+    sound_init();
+    sound_reset(preset);
+    if (seqId >= gSequenceCount) {
+        fprintf(stderr, "Sequence 0x%x out of range (%d sequences)\n", seqId, gSequenceCount);
+        fclose(fp);
+        return 1;
+    }
+    if (bankId >= 0) {
+        override_default_bank(seqId, bankId);
+    }
+    play_music(SEQ_PLAYER_LEVEL, SEQUENCE_ARGS(4, seqId), 0);
+
+#ifdef AUDIO_PROFILER
+    audio_profiler_reset();
+#endif
+
+    // Mirror produce_one_frame(): the game ticks once per two audio buffers,
+    // and the buffer size alternates to track the output frequency.
+    frames = seconds * UPDATES_PER_SECOND;
+    start = timer_now_ns();
+    for (frame = 0; frame < frames; frame++) {
+        u32 numSamples = (u64) written * UPDATES_PER_SECOND < expected ? SAMPLES_HIGH : SAMPLES_LOW;
+
+        if ((frame & 1) == 0) {
+            audio_signal_game_loop_tick();
+        }
+        create_next_audio_buffer(buffer, numSamples);
+        fwrite(buffer, sizeof(s16) * 2, numSamples, fp);
+        written += numSamples;
+        expected += OUTPUT_FREQUENCY;
+    }
+    elapsed = timer_now_ns() - start;
+
+    fseek(fp, 0, SEEK_SET);
+    write_wav_header(fp, written * 2 * sizeof(s16));
+    fclose(fp);
+
+    printf("Rendered sequence 0x%02x: %u samples (%.2f s) in %.3f s, %.1fx realtime\n", seqId, written,
+           (double) written / OUTPUT_FREQUENCY, elapsed / 1e9,
+           ((double) written / OUTPUT_FREQUENCY) / (elapsed / 1e9));
+    printf("Notes: %d of %d used, peak %u voices, %u stolen while decaying, %u stolen while active, %u dropped\n",
+           gNotePoolStats.inUse, gNotePoolStats.capacity, gNotePoolStats.peakVoices, gNotePoolStats.stolenDecaying,
+           gNotePoolStats.stolenActive, gNotePoolStats.dropped);
+#ifdef AUDIO_PROFILER
+    for (i = 0; i < AUDIO_PROFILER_STAGE_COUNT; i++) {
+        printf("  %-24s %9.3f ms %8u calls %6.2f%%\n", audio_profiler_stage_name(i),
+               gAudioProfilerStats[i].totalNs / 1e6, gAudioProfilerStats[i].calls,
+               100.0 * gAudioProfilerStats[i].totalNs / elapsed);
+    }
+    if (gNotePoolStats.voiceUpdates != 0) {
+        printf("  %.3f us of note synthesis per voice per update\n",
+               gAudioProfilerStats[AUDIO_PROFILER_SYNTHESIS_PROCESS_NOTES].totalNs / 1e3
+                   / gNotePoolStats.voiceUpdates);
+    }
+#else
+    (void) i;
+    printf("  (build with ENABLE_AUDIO_PROFILER=1 for per-stage timings)\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,276 @@
+// behavior_script_bench.c - checks and benchmarks the threaded code behavior interpreter in
+// src/engine/behavior_script.c.
+//
+// Built with 'make behavior_script_bench'. Runs every script in behavior_data.c on a few
+// objects for a number of frames, once through the BehaviorCmdTable loop and once through the
+// threaded code, checks that the objects end up the same and that the scripts made the same
+// calls in the same order, and prints the time per object update of each.
+//
+// The native functions and the game data the scripts refer to are stubs that the Makefile
+// generates from the symbols behavior_data.o leaves undefined. Each stub function changes
+// some fields of the current object depending on its own number and the object's state, so a
+// script that calls them in another order or on another object shows up in both the call log
+// and the objects.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "engine/behavior_script.h"
+#include "engine/graph_node.h"
+#include "engine/surface_collision.h"
+#include "game/object_helpers.h"
+#include "game/object_list_processor.h"
+#include "pc/timer.h"
+
+#define NUM_OBJECTS 8
+#define MAX_LOG 0x10000
+
+// Generated by the Makefile
+extern const BehaviorScript *const gBenchScripts[];
+extern const char *const gBenchScriptNames[];
+extern const s32 gBenchScriptCount;
+
+// The game code behavior_script.c links against
+struct Object gObjectPool[OBJECT_POOL_CAPACITY];
+struct Object *gCurrentObject;
+struct Object *gMarioObject;
+const BehaviorScript *gCurBhvCommand;
+u32 gGlobalTimer;
+static struct GraphNode *sLoadedGraphNodes[0x100];
+struct GraphNode **gLoadedGraphNodes = sLoadedGraphNodes;
+
+struct Run {
+    void (*interpret)(void);
+    struct Object *objects;
+    struct Object spawned; // What the spawn commands return
+    u32 log[MAX_LOG];
+    u32 logLength;
+    u64 time;
+};
+
+static struct Run *sRun;
+
+static void log_call(u32 value) {
+    if (sRun->logLength < MAX_LOG) {
+        sRun->log[sRun->logLength++] = value;
+    }
+}
+
+// Called by the generated stubs
+void bench_native(s32 id) {
+    struct Object *obj = gCurrentObject;
+    u32 hash = (u32) id * 2654435761u ^ (u32) obj->rawData.asS32[(id * 7) % 0x50] ^ gGlobalTimer * 40503u;
+
+    log_call(0x10000000 | id);
+    if (hash % 3 == 0) {
+        obj->rawData.asS32[hash % 0x50] += (hash >> 8) & 0xFF;
+    }
+    if (hash % 5 == 0) {
+        obj->oAction = hash & 7;
+    }
+}
+
+void bhv_init_room(void) {
+    log_call(1);
+}
+
+s32 cur_obj_has_behavior(UNUSED const BehaviorScript *behavior) {
+    return FALSE;
+}
+
+void cur_obj_enable_rendering_if_mario_in_room(void) {
+}
+
+void cur_obj_hide(void) {
+    gCurrentObject->header.gfx.node.flags &= ~GRAPH_RENDER_ACTIVE;
+}
+
+void cur_obj_move_xz_using_fvel_and_yaw(void) {
+}
+
+void cur_obj_move_y_with_terminal_vel(void) {
+}
+
+void cur_obj_scale(f32 scale) {
+    gCurrentObject->header.gfx.scale[0] = scale;
+    gCurrentObject->header.gfx.scale[1] = scale;
+    gCurrentObject->header.gfx.scale[2] = scale;
+}
+
+f32 dist_between_objects(UNUSED struct Object *obj1, UNUSED struct Object *obj2) {
+    return 100.0f;
+}
+
+f32 find_floor_height(f32 x, f32 y, f32 z) {
+    return x + y + z;
+}
+
+void geo_obj_init_animation(UNUSED struct GraphNodeObject *graphNode, struct Animation **animPtrAddr) {
+    log_call(2);
+    log_call((u32) (uintptr_t) animPtrAddr);
+}
+
+s16 obj_angle_to_object(UNUSED struct Object *obj1, UNUSED struct Object *obj2) {
+    return 0;
+}
+
+void obj_build_transform_relative_to_parent(UNUSED struct Object *obj) {
+}
+
+void obj_copy_pos_and_angle(UNUSED struct Object *dst, UNUSED struct Object *src) {
+    log_call(3);
+}
+
+void obj_set_face_angle_to_move_angle(UNUSED struct Object *obj) {
+}
+
+void obj_set_throw_matrix_from_transform(UNUSED struct Object *obj) {
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+struct Object *spawn_object_at_origin(UNUSED struct Object *parent, UNUSED s32 unusedArg, u32 model,
+                                      const BehaviorScript *behavior) {
+    log_call(4);
+    log_call(model);
+    log_call((u32) (uintptr_t) behavior);
+    return &sRun->spawned;
+}
+
+struct Object *spawn_water_droplet(UNUSED struct Object *parent, struct WaterDropletParams *params) {
+    log_call(5);
+    log_call((u32) (uintptr_t) params);
+    return &sRun->spawned;
+}
+
+#ifdef BHV_THREADED_CODE
+// Only the threaded run uses objects of the pool, like the game, so that its resume cache is used
+static struct Object sTableObjects[NUM_OBJECTS];
+
+static struct Run sRuns[2] = {
+    { .interpret = bhv_run_table, .objects = sTableObjects },
+    { .interpret = bhv_run_threaded, .objects = gObjectPool },
+};
+
+// Scripts that end in RETURN are subroutines, so they return to a BREAK
+static const BehaviorScript sBreak[] = { 0x0A000000 };
+
+static void run_script(struct Run *run, const BehaviorScript *script, u32 frames) {
+    struct Object *objects = run->objects;
+    u64 start;
+    u32 frame;
+    s32 i;
+
+    sRun = run;
+    memset(objects, 0, NUM_OBJECTS * sizeof(struct Object));
+    memset(&run->spawned, 0, sizeof(run->spawned));
+    run->logLength = 0;
+    for (i = 0; i < NUM_OBJECTS; i++) {
+        objects[i].curBhvCommand = script;
+        objects[i].behavior = script;
+        objects[i].activeFlags = ACTIVE_FLAG_ACTIVE;
+        objects[i].parentObj = &objects[(i + 1) % NUM_OBJECTS];
+        objects[i].bhvStack[0] = (uintptr_t) sBreak;
+        objects[i].bhvStackIndex = 1;
+        objects[i].oBehParams = i * 3;
+    }
+    random_set_seed(0);
+    gMarioObject = &objects[0];
+
+    start = timer_now_ns();
+    for (frame = 0; frame < frames; frame++) {
+        gGlobalTimer = frame + 1;
+        for (i = 0; i < NUM_OBJECTS; i++) {
+            if (objects[i].activeFlags == ACTIVE_FLAG_DEACTIVATED) {
+                continue;
+            }
+            log_call(0xAA000000 | i);
+            gCurrentObject = &objects[i];
+            gCurBhvCommand = gCurrentObject->curBhvCommand;
+            run->interpret();
+            gCurrentObject->curBhvCommand = gCurBhvCommand;
+        }
+    }
+    run->time += timer_now_ns() - start;
+}
+
+// The object a pointer of an object points to, as an index into the run's objects, with
+// NUM_OBJECTS for the spawned object, so it can be compared between the runs
+static uintptr_t object_id(struct Run *run, struct Object *obj) {
+    if (obj == &run->spawned) {
+        return NUM_OBJECTS;
+    }
+    if (obj >= run->objects && obj < run->objects + NUM_OBJECTS) {
+        return obj - run->objects;
+    }
+    return (uintptr_t) obj;
+}
+
+static u32 compare_runs(const char *script) {
+    struct Run *table = &sRuns[0];
+    struct Run *threaded = &sRuns[1];
+    struct Object obj;
+    s32 i;
+
+    for (i = 0; i < NUM_OBJECTS; i++) {
+        obj = threaded->objects[i];
+        if (object_id(threaded, obj.parentObj) != object_id(table, table->objects[i].parentObj)
+            || object_id(threaded, obj.prevObj) != object_id(table, table->objects[i].prevObj)) {
+            printf("%s: object %d points at another object\n", script, i);
+            return 1;
+        }
+        obj.parentObj = table->objects[i].parentObj;
+        obj.prevObj = table->objects[i].prevObj;
+        if (memcmp(&obj, &table->objects[i], sizeof(obj)) != 0) {
+            printf("%s: object %d differs\n", script, i);
+            return 1;
+        }
+    }
+    if (threaded->logLength != table->logLength
+        || memcmp(threaded->log, table->log, table->logLength * sizeof(u32)) != 0) {
+        printf("%s: calls differ (%u vs %u)\n", script, threaded->logLength, table->logLength);
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    u32 frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 400;
+#ifdef BHV_THREADED_CODE
+    u32 errors = 0;
+    u64 updates;
+    s32 i;
+#endif
+
+    if (argc > 2 || frames == 0) {
+        fprintf(stderr, "Usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+#ifdef BHV_THREADED_CODE
+    for (i = 0; i < gBenchScriptCount; i++) {
+        run_script(&sRuns[0], gBenchScripts[i], frames);
+        run_script(&sRuns[1], gBenchScripts[i], frames);
+        errors += compare_runs(gBenchScriptNames[i]);
+    }
+
+    updates = (u64) gBenchScriptCount * frames * NUM_OBJECTS;
+    printf("%d scripts on %d objects for %u frames, %u errors\n", gBenchScriptCount, NUM_OBJECTS,
+           frames, errors);
+    printf("  table    %7.2f ns/update\n", (double) sRuns[0].time / updates);
+    printf("  threaded %7.2f ns/update, %.2fx\n", (double) sRuns[1].time / updates,
+           (double) sRuns[0].time / sRuns[1].time);
+    return errors != 0;
+#else
+    printf("Built without the threaded code, nothing to check\n");
+    return 0;
+#endif
+}
@@ -68,6 +68,21 @@ unsigned int configKeyStickLeft  = 0;
 unsigned int configKeyStickRight = 0;
 #endif
 
+// Rate the audio device is opened at; the game's output is resampled to it if needed
+unsigned int configAudioOutputRate = 32000;
+// Target amount of audio queued in the device, in milliseconds; 0 keeps the original heuristic
+unsigned int configAudioLatencyMs  = 0;
+// Periodically print buffering statistics (queue depth, latency, underruns) to stderr
+bool configAudioStats              = false;
+// Let the note pool grow up to this many voices instead of stealing notes; 0 keeps the game's limits
+unsigned int configAudioMaxNotes   = 0;
+// Run reverb at the synthesis rate instead of downsampling it (EU uses 4x downsampled reverb)
+bool configAudioReverbFullRate     = false;
+// Size of the main memory pool in MiB, reserved up front and backed as it's used; 0 keeps the built-in size
+unsigned int configMainPoolMb      = 0;
+// Threads used to compute object matrices while rendering, counting the main thread; 0 or 1 is off
+unsigned int configRenderThreads   = 0;
+
 
 static const struct ConfigOption options[] = {
     {.name = "fullscreen",     .type = CONFIG_TYPE_BOOL, .boolValue = &configFullscreen},
@@ -86,6 +101,13 @@ static const struct ConfigOption options[] = {
     {.name = "key_stickdown",  .type = CONFIG_TYPE_UINT, .uintValue = &configKeyStickDown},
     {.name = "key_stickleft",  .type = CONFIG_TYPE_UINT, .uintValue = &configKeyStickLeft},
     {.name = "key_stickright", .type = CONFIG_TYPE_UINT, .uintValue = &configKeyStickRight},
+    {.name = "audio_output_rate", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioOutputRate},
+    {.name = "audio_latency_ms", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioLatencyMs},
+    {.name = "audio_stats",    .type = CONFIG_TYPE_BOOL, .boolValue = &configAudioStats},
+    {.name = "audio_max_notes", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioMaxNotes},
+    {.name = "audio_reverb_full_rate", .type = CONFIG_TYPE_BOOL, .boolValue = &configAudioReverbFullRate},
+    {.name = "main_pool_mb",   .type = CONFIG_TYPE_UINT, .uintValue = &configMainPoolMb},
+    {.name = "render_threads", .type = CONFIG_TYPE_UINT, .uintValue = &configRenderThreads},
 #endif
 };
 
@@ -1,6 +1,8 @@
 #ifndef CONFIGFILE_H
 #define CONFIGFILE_H
 
+#include <stdbool.h>
+
 extern bool         configFullscreen;
 extern unsigned int configKeyA;
 extern unsigned int configKeyB;
@@ -16,6 +18,13 @@ extern unsigned int configKeyStickUp;
 extern unsigned int configKeyStickDown;
 extern unsigned int configKeyStickLeft;
 extern unsigned int configKeyStickRight;
+extern unsigned int configAudioOutputRate;
+extern unsigned int configAudioLatencyMs;
+extern bool         configAudioStats;
+extern unsigned int configAudioMaxNotes;
+extern bool         configAudioReverbFullRate;
+extern unsigned int configMainPoolMb;
+extern unsigned int configRenderThreads;
 
 void configfile_load(const char *filename);
 void configfile_save(const char *filename);
@@ -2,21 +2,48 @@
 #include <ultra64.h>
 
 #include "controller_api.h"
+#include "controller_recorded_tas.h"
 
 static FILE *fp;
+static const char *tas_file = "cont.m64";
+static uint32_t tas_samples;
+
+void controller_recorded_tas_set_file(const char *path) {
+    tas_file = path;
+}
+
+uint32_t controller_recorded_tas_samples(void) {
+    return tas_samples;
+}
+
+void controller_recorded_tas_seek(uint32_t sample) {
+    if (fp != NULL) {
+        fseek(fp, 0x400 + sample * 4, SEEK_SET);
+    }
+}
 
 static void tas_init(void) {
-    fp = fopen("cont.m64", "rb");
+    fp = fopen(tas_file, "rb");
     if (fp != NULL) {
         uint8_t buf[0x400];
-        fread(buf, 1, sizeof(buf), fp);
+        if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf)) {
+            fprintf(stderr, "%s: not a .m64 file\n", tas_file);
+            fclose(fp);
+            fp = NULL;
+            return;
+        }
+        // Number of input samples, little endian at 0x018 of the .m64 header
+        tas_samples = buf[0x18] | (buf[0x19] << 8) | (buf[0x1A] << 16) | ((uint32_t) buf[0x1B] << 24);
     }
 }
 
 static void tas_read(OSContPad *pad) {
     if (fp != NULL) {
-        uint8_t bytes[4] = {0};
-        fread(bytes, 1, 4, fp);
+        uint8_t bytes[4];
+        // Past the last sample the controller is left at rest
+        if (fread(bytes, 1, 4, fp) != 4) {
+            return;
+        }
         pad->button = (bytes[0] << 8) | bytes[1];
         pad->stick_x = bytes[2];
         pad->stick_y = bytes[3];
@@ -5,4 +5,13 @@
 
 extern struct ControllerAPI controller_recorded_tas;
 
+// Reads the inputs from path instead of cont.m64. Must be called before init.
+void controller_recorded_tas_set_file(const char *path);
+
+// Number of input samples in the file's header, 0 if there's no file.
+uint32_t controller_recorded_tas_samples(void);
+
+// Makes the next read return the given input sample.
+void controller_recorded_tas_seek(uint32_t sample);
+
 #endif
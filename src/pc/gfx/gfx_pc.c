@@ -149,6 +149,7 @@ static struct RenderingState {
     struct XYWidthHeight viewport, scissor;
     struct ShaderProgram *shader_program;
     struct TextureHashmapNode *textures[2];
+    int8_t last_imported_tile; // -1 until a texture is imported in the frame
 } rendering_state;
 
 struct GfxDimensions gfx_current_dimensions;
@@ -320,6 +321,19 @@ static bool gfx_texture_cache_lookup(int tile, struct TextureHashmapNode **n, co
     return false;
 }
 
+// Whether the texture loaded for tile is the one already bound to it. Display lists often load the
+// same texture again, like the envfx bubbles for every 5 particles, and importing it again would
+// end the batch of triangles for nothing. Only the tile imported last counts: the 3DS backend
+// scales texture coordinates by the texture selected last, and its menu and minimap bind textures
+// of their own between frames.
+static bool gfx_texture_is_bound(int tile) {
+    const struct TextureHashmapNode *node = rendering_state.textures[tile];
+
+    return rendering_state.last_imported_tile == tile && node != NULL &&
+           node->texture_addr == rdp.loaded_texture[tile].addr &&
+           node->fmt == rdp.texture_tile.fmt && node->siz == rdp.texture_tile.siz;
+}
+
 static uint8_t rgba32_buf[32768] __attribute__((aligned(32)));
 
 static void import_texture_rgba16(int tile) {
@@ -490,6 +504,8 @@ static void import_texture(int tile) {
     uint8_t fmt = rdp.texture_tile.fmt;
     uint8_t siz = rdp.texture_tile.siz;
 
+    rendering_state.last_imported_tile = tile;
+
     if (gfx_texture_cache_lookup(tile, &rendering_state.textures[tile], rdp.loaded_texture[tile].addr, fmt, siz)) {
         return;
     }
@@ -780,7 +796,7 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx) {
         const float dx2 = v3->x * recip3 - v2->x * recip2;
         const float dy2 = v3->y * recip3 - v2->y * recip2;
 
-        const float cross = dx1 * dy2 - dy1 * dx2;
+        float cross = dx1 * dy2 - dy1 * dx2;
 
 #ifdef TARGET_N3DS
         // Quick maffs
@@ -888,8 +904,10 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx) {
     for (int i = 0; i < 2; i++) {
         if (used_textures[i]) {
             if (rdp.textures_changed[i]) {
-                gfx_flush();
-                import_texture(i);
+                if (!gfx_texture_is_bound(i)) {
+                    gfx_flush();
+                    import_texture(i);
+                }
                 rdp.textures_changed[i] = false;
             }
             bool linear_filter = (rdp.other_mode_h & (3U << G_MDSFT_TEXTFILT)) != G_TF_POINT;
@@ -1746,6 +1764,7 @@ void gfx_run(Gfx *commands) {
         return;
     }
     dropped_frame = false;
+    rendering_state.last_imported_tile = -1;
 
     profiler_3ds_log_time(0);
     gfx_rapi->start_frame();
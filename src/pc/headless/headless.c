@@ -0,0 +1,82 @@
+// headless.c - the parts of pc_main.c the game code needs, for tools without a window or any
+// backend, see headless.h.
+
+#ifndef TARGET_N3DS
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "headless.h"
+
+#ifdef VERSION_EU
+#define SAMPLES_LOW 640
+#define UPDATES_PER_SECOND 50
+#else
+#define SAMPLES_LOW 528
+#define UPDATES_PER_SECOND 60
+#endif
+#define OUTPUT_FREQUENCY 32000
+
+OSMesg D_80339BEC;
+OSMesgQueue gSIEventMesgQueue;
+s8 gResetTimer;
+s8 D_8032C648;
+s8 gDebugLevelSelect;
+s8 gShowProfiler;
+s8 gShowDebugText;
+
+struct ControllerAPI *gHeadlessController;
+struct HeadlessAudioClock gHeadlessAudioClock;
+
+extern void create_next_audio_buffer(s16 *samples, u32 num_samples);
+
+void dispatch_audio_sptask(UNUSED struct SPTask *spTask) {
+}
+
+void set_vblank_handler(UNUSED s32 index, UNUSED struct VblankHandler *handler, UNUSED OSMesgQueue *queue,
+                        UNUSED OSMesg *msg) {
+}
+
+// The display lists are built, unless gGeoSkipDisplayLists is set, but nothing draws them
+void send_display_list(UNUSED struct SPTask *spTask) {
+}
+
+// Only gHeadlessController reaches the game, not the controllers that happen to be plugged in
+s32 osContInit(UNUSED OSMesgQueue *mq, u8 *controllerBits, UNUSED OSContStatus *status) {
+    if (gHeadlessController != NULL && gHeadlessController->init != NULL) {
+        gHeadlessController->init();
+    }
+    *controllerBits = 1;
+    return 0;
+}
+
+s32 osContStartReadData(UNUSED OSMesgQueue *mesg) {
+    return 0;
+}
+
+void osContGetReadData(OSContPad *pad) {
+    pad->button = 0;
+    pad->stick_x = 0;
+    pad->stick_y = 0;
+    pad->errnum = 0;
+    if (gHeadlessController != NULL) {
+        gHeadlessController->read(pad);
+    }
+}
+
+u32 headless_produce_audio(s16 *buffer) {
+    struct HeadlessAudioClock *clock = &gHeadlessAudioClock;
+    u32 numSamples =
+        clock->samplesWritten * UPDATES_PER_SECOND < clock->samplesExpected ? HEADLESS_SAMPLES_HIGH : SAMPLES_LOW;
+    s32 i;
+
+    for (i = 0; i < 2; i++) {
+        create_next_audio_buffer(buffer + i * (numSamples * 2), numSamples);
+    }
+    clock->samplesWritten += 2 * numSamples;
+    clock->samplesExpected += 2 * OUTPUT_FREQUENCY;
+    return numSamples;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <PR/ultratypes.h>
+
+#include "pc/controller/controller_api.h"
+
+// What pc_main.c otherwise provides to the game code, for the tools that run the game without a
+// window or any backend: the replay tool (src/pc/replay) and the simulation library (src/pc/sim).
+// Nothing draws the display lists or plays the audio.
+
+#ifdef VERSION_EU
+#define HEADLESS_SAMPLES_HIGH 656
+#else
+#define HEADLESS_SAMPLES_HIGH 544
+#endif
+
+// Enough for the audio of one frame, see headless_produce_audio
+#define HEADLESS_AUDIO_BUFFER_LEN (HEADLESS_SAMPLES_HIGH * 2 * 2)
+
+// Samples produced so far, and the samples there should have been at the output frequency.
+// Tools that restore save states restore these along with them.
+struct HeadlessAudioClock {
+    u64 samplesWritten;
+    u64 samplesExpected;
+};
+
+// The only controller the game reads; NULL leaves it at rest. Its init, if any, runs when the
+// game boots.
+extern struct ControllerAPI *gHeadlessController;
+
+extern struct HeadlessAudioClock gHeadlessAudioClock;
+
+extern const char *gEepromFile;
+
+void thread5_game_loop(void *arg);
+void game_loop_one_iteration(void);
+
+// Synthesizes the audio of a frame into buffer the way produce_one_frame does, with the buffer
+// size alternating to average out to the output frequency. Returns the number of stereo samples
+// in each of the two buffers it fills.
+u32 headless_produce_audio(s16 *buffer);
+
+#endif
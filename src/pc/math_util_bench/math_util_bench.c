@@ -0,0 +1,210 @@
+// math_util_bench.c - checks and benchmarks the SIMD matrix functions in src/engine/math_util.c.
+//
+// Built with 'make math_util_bench'. Runs the SSE2/NEON versions and the scalar ones on the
+// same random transformation matrices, checks that the results agree (mtxf_to_mtx bit for
+// bit, the rest within float rounding), and prints the time per call of each.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "pc/timer.h"
+
+// The game code math_util.c links against
+Vec3f gVec3fZero = { 0.0f, 0.0f, 0.0f };
+
+f32 find_floor(UNUSED f32 x, UNUSED f32 y, UNUSED f32 z, struct Surface **pfloor) {
+    *pfloor = NULL;
+    return -11000.0f;
+}
+
+#define NUM_MATRICES 1024
+
+// Error allowed between the two versions, relative to the largest element of the matrix, for
+// compilers that fuse the scalar multiplies and adds. An element that is a sum of large terms
+// that cancel out can only be as exact as the terms.
+#define TOLERANCE 1e-5f
+
+static Mat4 sMatrices[NUM_MATRICES];
+static Vec3f sPositions[NUM_MATRICES];
+static Vec3s sAngles[NUM_MATRICES];
+static volatile f32 sSink;
+
+static u32 sRandState = 1;
+
+static f32 random_float(f32 range) {
+    sRandState = sRandState * 1103515245 + 12345;
+    return ((f32) (sRandState >> 8) / (1 << 24) * 2.0f - 1.0f) * range;
+}
+
+// Random rotation, scale and translation, like the object and bone matrices of a frame
+static void init_inputs(void) {
+    Vec3f scale;
+    s32 i;
+
+    for (i = 0; i < NUM_MATRICES; i++) {
+        vec3f_set(sPositions[i], random_float(8000.0f), random_float(8000.0f), random_float(8000.0f));
+        vec3s_set(sAngles[i], random_float(32767.0f), random_float(32767.0f), random_float(32767.0f));
+        vec3f_set(scale, 0.1f + fabsf(random_float(4.0f)), 0.1f + fabsf(random_float(4.0f)),
+                  0.1f + fabsf(random_float(4.0f)));
+        mtxf_rotate_zxy_and_translate(sMatrices[i], sPositions[i], sAngles[i]);
+        mtxf_scale_vec3f(sMatrices[i], sMatrices[i], scale);
+    }
+}
+
+static s32 compare_mtxf(const char *name, s32 index, Mat4 simd, Mat4 scalar) {
+    f32 largest = 1.0f;
+    s32 i, j;
+
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            largest = fmaxf(largest, fabsf(scalar[i][j]));
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            f32 diff = fabsf(simd[i][j] - scalar[i][j]);
+
+            if (diff > TOLERANCE * largest) {
+                printf("%s: matrix %d differs at [%d][%d]: %g vs %g\n", name, index, i, j, simd[i][j],
+                       scalar[i][j]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+#ifdef MATH_UTIL_SIMD
+static u32 check(void) {
+    u32 errors = 0;
+    Mat4 simd, scalar;
+    Mtx simdMtx, scalarMtx;
+    Vec3s simdVec, scalarVec;
+    s32 i;
+
+    for (i = 0; i < NUM_MATRICES; i++) {
+        Mat4 *a = &sMatrices[i];
+        Mat4 *b = &sMatrices[(i * 7 + 1) % NUM_MATRICES];
+
+        mtxf_mul(simd, *a, *b);
+        mtxf_mul_scalar(scalar, *a, *b);
+        errors += compare_mtxf("mtxf_mul", i, simd, scalar);
+
+        // In place, as the game does with dest == a or dest == b
+        mtxf_copy(simd, *a);
+        mtxf_mul(simd, simd, *b);
+        errors += compare_mtxf("mtxf_mul (dest == a)", i, simd, scalar);
+        mtxf_copy(simd, *b);
+        mtxf_mul(simd, *a, simd);
+        errors += compare_mtxf("mtxf_mul (dest == b)", i, simd, scalar);
+
+        mtxf_billboard(simd, *a, sPositions[i], sAngles[i][0]);
+        mtxf_billboard_scalar(scalar, *a, sPositions[i], sAngles[i][0]);
+        errors += compare_mtxf("mtxf_billboard", i, simd, scalar);
+
+        // Keep the results in range of the s16 vector, so only rounding can differ
+        vec3s_set(simdVec, random_float(1000.0f), random_float(1000.0f), random_float(1000.0f));
+        vec3s_copy(scalarVec, simdVec);
+        mtxf_copy(simd, *a);
+        simd[3][0] = simd[3][1] = simd[3][2] = 0.0f;
+        mtxf_mul_vec3s(simd, simdVec);
+        mtxf_mul_vec3s_scalar(simd, scalarVec);
+        if (abs(simdVec[0] - scalarVec[0]) > 1 || abs(simdVec[1] - scalarVec[1]) > 1
+            || abs(simdVec[2] - scalarVec[2]) > 1) {
+            printf("mtxf_mul_vec3s: matrix %d differs: (%d %d %d) vs (%d %d %d)\n", i, simdVec[0], simdVec[1],
+                   simdVec[2], scalarVec[0], scalarVec[1], scalarVec[2]);
+            errors++;
+        }
+
+        // Scaled down so the fixed point conversion doesn't overflow
+        mtxf_copy(simd, *a);
+        simd[3][0] /= 4.0f;
+        simd[3][1] /= 4.0f;
+        simd[3][2] /= 4.0f;
+        memset(&simdMtx, 0, sizeof(simdMtx));
+        memset(&scalarMtx, 0, sizeof(scalarMtx));
+        mtxf_to_mtx(&simdMtx, simd);
+        mtxf_to_mtx_scalar(&scalarMtx, simd);
+        if (memcmp(&simdMtx, &scalarMtx, sizeof(Mtx)) != 0) {
+            printf("mtxf_to_mtx: matrix %d differs\n", i);
+            errors++;
+        }
+    }
+    return errors;
+}
+#endif
+
+// Times call over all the matrices, rounds times, and returns the time per call in ns
+#define BENCH(call, result)                                                                  \
+    {                                                                                        \
+        u64 start = timer_now_ns();                                                          \
+        for (r = 0; r < rounds; r++) {                                                       \
+            for (i = 0; i < NUM_MATRICES; i++) {                                             \
+                call;                                                                        \
+            }                                                                                \
+            sSink += out[0][0];                                                              \
+        }                                                                                    \
+        result = (double) (timer_now_ns() - start) / rounds / NUM_MATRICES;                  \
+    }
+
+#ifdef MATH_UTIL_SIMD
+#define BENCH_PAIR(name, simdCall, scalarCall)                                               \
+    {                                                                                        \
+        double simdNs, scalarNs;                                                             \
+        BENCH(scalarCall, scalarNs);                                                         \
+        BENCH(simdCall, simdNs);                                                             \
+        printf("  %-32s %7.2f ns/call, scalar %7.2f ns/call, %.2fx\n", name, simdNs, scalarNs, \
+               scalarNs / simdNs);                                                           \
+    }
+#else
+#define BENCH_PAIR(name, simdCall, scalarCall)                                               \
+    {                                                                                        \
+        double ns;                                                                           \
+        BENCH(simdCall, ns);                                                                 \
+        printf("  %-32s %7.2f ns/call\n", name, ns);                                         \
+    }
+#endif
+
+int main(int argc, char *argv[]) {
+    u32 rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 10000;
+    u32 errors = 0;
+    Mat4 out;
+    Mtx outMtx;
+    Vec3s vec;
+    u32 r;
+    s32 i;
+
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    init_inputs();
+    mtxf_identity(out);
+
+#ifdef MATH_UTIL_SIMD
+    errors = check();
+    printf("%u matrices checked, %u errors\n", NUM_MATRICES, errors);
+#else
+    printf("Built without SSE2 or NEON, only timing the scalar versions\n");
+#endif
+
+    printf("%u rounds of %u matrices\n", rounds, NUM_MATRICES);
+    BENCH_PAIR("mtxf_mul", mtxf_mul(out, sMatrices[i], sMatrices[(i + 1) % NUM_MATRICES]),
+               mtxf_mul_scalar(out, sMatrices[i], sMatrices[(i + 1) % NUM_MATRICES]));
+    BENCH_PAIR("mtxf_billboard", mtxf_billboard(out, sMatrices[i], sPositions[i], sAngles[i][0]),
+               mtxf_billboard_scalar(out, sMatrices[i], sPositions[i], sAngles[i][0]));
+    BENCH_PAIR("mtxf_mul_vec3s",
+               (vec3s_set(vec, 100, 200, 300), mtxf_mul_vec3s(sMatrices[i], vec), out[0][0] = vec[0]),
+               (vec3s_set(vec, 100, 200, 300), mtxf_mul_vec3s_scalar(sMatrices[i], vec), out[0][0] = vec[0]));
+    BENCH_PAIR("mtxf_to_mtx", (mtxf_to_mtx(&outMtx, sMatrices[i]), out[0][0] = outMtx.m[0][0]),
+               (mtxf_to_mtx_scalar(&outMtx, sMatrices[i]), out[0][0] = outMtx.m[0][0]));
+    return errors != 0;
+}
@@ -0,0 +1,234 @@
+// mem_pool_bench.c - stress test and benchmark for the mem_pool allocator in src/game/memory.c.
+//
+// Built with 'make mem_pool_bench'. Runs a random mix of small and large allocations and
+// frees through mem_pool_alloc/mem_pool_free and through a copy of the original first fit
+// allocator, checks that no two live blocks overlap, and prints timings and the
+// fragmentation of the pool at the end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+
+#include "game/memory.h"
+#include "pc/timer.h"
+
+// The game code memory.c links against, for alloc_display_list
+Gfx *gDisplayListHead;
+u8 *gGfxPoolEnd;
+s16 gCurrLevelNum;
+
+#define MAX_LIVE 256
+
+struct Allocator {
+    const char *name;
+    void *(*alloc)(u32 size);
+    void (*free)(void *addr);
+};
+
+static struct MemoryPool *sPool;
+static struct MemoryPoolStats sStats; // The pool at the end of the last run, with its blocks still live
+
+static void *pool_alloc(u32 size) {
+    return mem_pool_alloc(sPool, size);
+}
+
+static void pool_free(void *addr) {
+    mem_pool_free(sPool, addr);
+}
+
+// The allocator mem_pool used before size classes: first fit over a single free list,
+// sorted by address and merged on every free.
+struct RefBlock {
+    struct RefBlock *next;
+    u32 size;
+};
+
+static struct RefBlock *sRefFreeList;
+
+static void ref_init(void *start, u32 size) {
+    sRefFreeList = start;
+    sRefFreeList->next = NULL;
+    sRefFreeList->size = size;
+}
+
+static void *ref_alloc(u32 size) {
+    struct RefBlock *freeBlock = (struct RefBlock *) &sRefFreeList;
+    void *addr = NULL;
+
+    size = ((size + 7) & ~7) + sizeof(struct RefBlock);
+    while (freeBlock->next != NULL) {
+        if (freeBlock->next->size >= size) {
+            addr = (u8 *) freeBlock->next + sizeof(struct RefBlock);
+            if (freeBlock->next->size - size <= sizeof(struct RefBlock)) {
+                freeBlock->next = freeBlock->next->next;
+            } else {
+                struct RefBlock *newBlock = (struct RefBlock *) ((u8 *) freeBlock->next + size);
+                newBlock->size = freeBlock->next->size - size;
+                newBlock->next = freeBlock->next->next;
+                freeBlock->next->size = size;
+                freeBlock->next = newBlock;
+            }
+            break;
+        }
+        freeBlock = freeBlock->next;
+    }
+    return addr;
+}
+
+static void ref_free(void *addr) {
+    struct RefBlock *block = (struct RefBlock *) ((u8 *) addr - sizeof(struct RefBlock));
+    struct RefBlock *freeList = sRefFreeList;
+
+    if (sRefFreeList == NULL) {
+        sRefFreeList = block;
+        block->next = NULL;
+    } else if (block < sRefFreeList) {
+        if ((u8 *) sRefFreeList == (u8 *) block + block->size) {
+            block->size += freeList->size;
+            block->next = freeList->next;
+        } else {
+            block->next = sRefFreeList;
+        }
+        sRefFreeList = block;
+    } else {
+        while (freeList->next != NULL && freeList->next < block) {
+            freeList = freeList->next;
+        }
+        if ((u8 *) freeList + freeList->size == (u8 *) block) {
+            freeList->size += block->size;
+            block = freeList;
+        } else {
+            block->next = freeList->next;
+            freeList->next = block;
+        }
+        if (block->next != NULL && (u8 *) block->next == (u8 *) block + block->size) {
+            block->size += block->next->size;
+            block->next = block->next->next;
+        }
+    }
+}
+
+static u32 sRandState;
+
+static u32 next_random(void) {
+    sRandState = sRandState * 1103515245 + 12345;
+    return sRandState >> 8;
+}
+
+// Mostly small allocations like text labels and chain segments, with the occasional
+// large one like an envfx particle buffer or a painting mesh.
+static u32 random_size(void) {
+    if (next_random() % 8 != 0) {
+        return 8 + next_random() % 248;
+    }
+    return 512 + next_random() % 3584;
+}
+
+// Returns the number of errors found. With check set, every block is filled with its slot number
+// and verified before it's freed, so overlapping blocks show up; the timed runs skip that.
+static u32 run(const struct Allocator *allocator, u32 iterations, u32 seed, s32 check, u32 *failed,
+               u64 *elapsed) {
+    static u8 *live[MAX_LIVE];
+    static u32 liveSize[MAX_LIVE];
+    u32 errors = 0;
+    u32 i, j;
+    u64 start;
+
+    memset(live, 0, sizeof(live));
+    sRandState = seed;
+    *failed = 0;
+    start = timer_now_ns();
+    for (i = 0; i < iterations; i++) {
+        u32 slot = next_random() % MAX_LIVE;
+
+        if (live[slot] != NULL) {
+            for (j = 0; check && j < liveSize[slot]; j++) {
+                if (live[slot][j] != (u8) slot) {
+                    errors++;
+                    break;
+                }
+            }
+            allocator->free(live[slot]);
+            live[slot] = NULL;
+        } else {
+            liveSize[slot] = random_size();
+            live[slot] = allocator->alloc(liveSize[slot]);
+            if (live[slot] == NULL) {
+                (*failed)++;
+            } else if (check) {
+                memset(live[slot], slot, liveSize[slot]);
+            }
+        }
+    }
+    *elapsed = timer_now_ns() - start;
+
+    if (allocator->alloc == pool_alloc) {
+        mem_pool_get_stats(sPool, &sStats);
+    }
+    for (i = 0; i < MAX_LIVE; i++) {
+        if (live[i] != NULL) {
+            allocator->free(live[i]);
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    static const struct Allocator allocators[] = {
+        { "first fit", ref_alloc, ref_free },
+        { "size classes", pool_alloc, pool_free },
+    };
+    u32 iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 10000000;
+    u32 poolSize = (argc > 2 ? strtoul(argv[2], NULL, 0) : 256) * 1024;
+    u32 seed = argc > 3 ? strtoul(argv[3], NULL, 0) : 1;
+    struct MemoryPoolStats stats;
+    u32 errors = 0;
+    u8 *mainPool;
+    u8 *refPool;
+    u32 i;
+
+    if (argc > 4) {
+        fprintf(stderr, "Usage: %s [iterations] [pool size in KiB] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    mainPool = malloc(poolSize + 0x1000);
+    refPool = malloc(poolSize);
+    if (mainPool == NULL || refPool == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    main_pool_init(mainPool, mainPool + poolSize + 0x1000);
+    sPool = mem_pool_init(poolSize, MEMORY_POOL_LEFT);
+    ref_init(refPool, poolSize);
+
+    printf("%u iterations, %u KiB pool, up to %u live blocks\n", iterations, poolSize / 1024, MAX_LIVE);
+    for (i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        u32 failed;
+        u64 elapsed;
+        u32 runErrors = run(&allocators[i], iterations, seed, TRUE, &failed, &elapsed);
+
+        run(&allocators[i], iterations, seed, FALSE, &failed, &elapsed);
+        printf("  %-12s %8.2f ns/op %8u failed allocations %u errors\n", allocators[i].name,
+               (double) elapsed / iterations, failed, runErrors);
+        errors += runErrors;
+    }
+
+    printf("Size classes: %u quick, %u list allocations, %u flushes\n", sStats.quickAllocs, sStats.listAllocs,
+           sStats.flushes);
+    printf("At the end: %u used, %u free in %u blocks (largest %u, %.1f%% fragmented), %u in %u size class blocks\n",
+           sStats.usedSpace, sStats.freeSpace, sStats.freeBlocks, sStats.largestFree,
+           sStats.freeSpace != 0 ? 100.0 - 100.0 * sStats.largestFree / sStats.freeSpace : 0.0,
+           sStats.quickSpace, sStats.quickBlocks);
+
+    // Every block was freed after the run, so all of the pool must be free again
+    mem_pool_get_stats(sPool, &stats);
+    if (stats.usedSpace != 0 || stats.freeSpace + stats.quickSpace != stats.totalSpace) {
+        printf("Leaked %u bytes\n", stats.totalSpace - stats.freeSpace - stats.quickSpace);
+        errors++;
+    }
+    return errors != 0;
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <ultra64.h>
 
+#include "audio/audio_profiler.h"
+
 // This file is ignored completely on N64.
 
 #undef aSegment
@@ -38,22 +40,23 @@ void aMixImpl(int16_t gain, uint16_t in_addr, uint16_t out_addr);
 
 // Redirects to the native versions of these functions.
 // The command increment is completely removed.
+// When the audio profiler is enabled, each op is timed under its stage.
 
 #define aSegment(pkt, s, b) do { } while(0)
-#define aClearBuffer(pkt, d, c) aClearBufferImpl(d, c)
-#define aLoadBuffer(pkt, s) aLoadBufferImpl(s) // Loads data from the given source into rspa.in
-#define aSaveBuffer(pkt, s) aSaveBufferImpl(s)
-#define aLoadADPCM(pkt, c, d) aLoadADPCMImpl(c, d)
+#define aClearBuffer(pkt, d, c) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aClearBufferImpl(d, c))
+#define aLoadBuffer(pkt, s) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aLoadBufferImpl(s)) // Loads data from the given source into rspa.in
+#define aSaveBuffer(pkt, s) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aSaveBufferImpl(s))
+#define aLoadADPCM(pkt, c, d) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ADPCM, aLoadADPCMImpl(c, d))
 #define aSetBuffer(pkt, f, i, o, c) aSetBufferImpl(f, i, o, c)
-#define aSetVolume(pkt, f, v, t, r) aSetVolumeImpl(f, v, t, r)
+#define aSetVolume(pkt, f, v, t, r) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ENVMIXER, aSetVolumeImpl(f, v, t, r))
 #define aSetVolume32(pkt, f, v, tr) aSetVolume(pkt, f, v, (int16_t)((tr) >> 16), (int16_t)(tr))
-#define aInterleave(pkt, l, r) aInterleaveImpl(l, r)
-#define aDMEMMove(pkt, i, o, c) aDMEMMoveImpl(i, o, c)
-#define aSetLoop(pkt, a) aSetLoopImpl(a)
-#define aADPCMdec(pkt, f, s) aADPCMdecImpl(f, s)
-#define aResample(pkt, f, p, s) aResampleImpl(f, p, s)
-#define aEnvMixer(pkt, f, s) aEnvMixerImpl(f, s)
-#define aMix(pkt, f, g, i, o) aMixImpl(g, i, o)
+#define aInterleave(pkt, l, r) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aInterleaveImpl(l, r))
+#define aDMEMMove(pkt, i, o, c) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aDMEMMoveImpl(i, o, c))
+#define aSetLoop(pkt, a) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ADPCM, aSetLoopImpl(a))
+#define aADPCMdec(pkt, f, s) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ADPCM, aADPCMdecImpl(f, s))
+#define aResample(pkt, f, p, s) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_RESAMPLE, aResampleImpl(f, p, s))
+#define aEnvMixer(pkt, f, s) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ENVMIXER, aEnvMixerImpl(f, s))
+#define aMix(pkt, f, g, i, o) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_MIX, aMixImpl(g, i, o))
 
 // Enhanced RSPA emulation allows us to break the rules of
 // RSPA emulation a little bit for better performance.
@@ -69,8 +72,8 @@ void aSnoop(volatile int snoopTag);
 void aADPCMdecDirectImpl(uint8_t flags, ADPCM_STATE state, uint8_t* source);
 void aInterleaveAndCopyImpl(uint16_t left, uint16_t right, int16_t *dest_addr);
 
-#define aADPCMdecDirect(pkt, f, s, src) aADPCMdecDirectImpl(f, s, src) // ADPCM Decode directly from external address
-#define aInterleaveAndCopy(pkt, l, r, dest) aInterleaveAndCopyImpl(l, r, dest) // Interleave directly to external address
+#define aADPCMdecDirect(pkt, f, s, src) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_ADPCM, aADPCMdecDirectImpl(f, s, src)) // ADPCM Decode directly from external address
+#define aInterleaveAndCopy(pkt, l, r, dest) AUDIO_PROFILER_WRAP(AUDIO_PROFILER_MIXER_OTHER, aInterleaveAndCopyImpl(l, r, dest)) // Interleave directly to external address
 
 #endif
 
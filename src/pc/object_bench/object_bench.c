@@ -0,0 +1,134 @@
+// object_bench.c - frame time with thousands of objects loaded.
+//
+// Built with 'make OBJECT_POOL_CAPACITY=4096 object_bench'. Plays a .m64 file up to a frame where
+// Mario is in a level, times a number of frames with only the level's own objects, then fills the
+// object pool with coins around Mario and times the same number of frames again. The coins that
+// despawn are spawned again between frames, outside of the timing.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "behavior_data.h"
+#include "game/level_update.h"
+#include "game/object_helpers.h"
+#include "game/object_list_processor.h"
+#include "model_ids.h"
+#include "pc/sim/sim.h"
+#include "pc/timer.h"
+
+// Free slots left for the objects the level and the coins spawn themselves, so the pool never
+// runs out, which hangs the game
+#define FREE_OBJECT_RESERVE 64
+
+#define COINS_PER_ROW 64
+#define COIN_SPACING 60
+
+static u32 count_free_objects(void) {
+    struct ObjectNode *node = gFreeObjectList.next;
+    u32 count = 0;
+
+    while (node != NULL) {
+        count++;
+        node = node->next;
+    }
+    return count;
+}
+
+// Spawns coins in a grid above Mario until there are numObjects objects or only the reserve is
+// left free. Every other coin moves, the rest stay put.
+static void fill_objects(u32 numObjects) {
+    u32 numFree = count_free_objects();
+    u32 numLive = OBJECT_POOL_CAPACITY - numFree;
+    static u32 sNextCoin;
+
+    while (numLive < numObjects && numFree > FREE_OBJECT_RESERVE) {
+        u32 i = sNextCoin++ % OBJECT_POOL_CAPACITY;
+        s16 x = gMarioObject->oPosX + ((s32) (i % COINS_PER_ROW) - COINS_PER_ROW / 2) * COIN_SPACING;
+        s16 z = gMarioObject->oPosZ + 400 + (s32) (i / COINS_PER_ROW) * COIN_SPACING;
+
+        spawn_object_abs_with_rot(gMarioObject, 0, MODEL_YELLOW_COIN,
+                                  (i % 2) ? bhvMovingYellowCoin : bhvYellowCoin, x,
+                                  gMarioObject->oPosY + 200, z, 0, 0, 0);
+        numLive++;
+        numFree--;
+    }
+}
+
+static f64 time_frames(const struct SimInput *input, u32 frames, u32 numObjects, u32 *peakLive) {
+    u64 total = 0;
+    u64 start;
+    u32 live;
+    u32 i;
+
+    *peakLive = 0;
+    for (i = 0; i < frames; i++) {
+        if (numObjects != 0) {
+            fill_objects(numObjects);
+        }
+        live = OBJECT_POOL_CAPACITY - count_free_objects();
+        if (live > *peakLive) {
+            *peakLive = live;
+        }
+        start = timer_now_ns();
+        sim_step(input, 1);
+        total += timer_now_ns() - start;
+    }
+    return total / 1e6 / frames;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-n objects] [-f frames] <inputs.m64>\n", name);
+    fprintf(stderr, "  -n  number of objects to load, the whole pool by default\n");
+    fprintf(stderr, "  -f  number of frames to time, 600 by default\n");
+}
+
+int main(int argc, char *argv[]) {
+    static const struct SimInput neutral = { 0, 0, 0 };
+    u32 numObjects = OBJECT_POOL_CAPACITY;
+    u32 frames = 600;
+    u32 numInputs;
+    struct SimInput *inputs;
+    u32 baseLive, fullLive;
+    f64 baseTime, fullTime;
+    s32 arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            numObjects = strtoul(argv[++arg], NULL, 0);
+        } else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) {
+            frames = strtoul(argv[++arg], NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - arg != 1 || frames == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    inputs = sim_load_m64(argv[arg], &numInputs);
+    if (inputs == NULL) {
+        return 1;
+    }
+
+    sim_init();
+    sim_step(inputs, numInputs);
+    if (gMarioObject == NULL) {
+        fprintf(stderr, "%s: Mario isn't in a level after the last input\n", argv[arg]);
+        return 1;
+    }
+
+    baseTime = time_frames(&neutral, frames, 0, &baseLive);
+    fullTime = time_frames(&neutral, frames, numObjects, &fullLive);
+
+    printf("Object pool capacity: %d\n", OBJECT_POOL_CAPACITY);
+    printf("Level objects only: up to %u live, %.3f ms/frame\n", baseLive, baseTime);
+    printf("With coins: up to %u live, %.3f ms/frame\n", fullLive, fullTime);
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <stdlib.h>
 
 #ifdef TARGET_WEB
@@ -9,6 +10,8 @@
 
 #include "game/memory.h"
 #include "audio/external.h"
+#include "audio/load.h"
+#include "audio/playback.h"
 
 #include "gfx/gfx_pc.h"
 #include "gfx/gfx_opengl.h"
@@ -27,6 +30,8 @@
 #include "audio/audio_sdl.h"
 #include "audio/audio_null.h"
 #include "audio/audio_3ds.h"
+#include "audio/audio_resampler.h"
+#include "audio/audio_buffering.h"
 
 #include "controller/controller_keyboard.h"
 
@@ -34,6 +39,18 @@
 
 #include "compat.h"
 
+#ifdef THREAD_POOL
+#include "thread_pool.h"
+#endif
+
+#ifndef TARGET_N3DS
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
 #define CONFIG_FILE "sm64config.txt"
 
 OSMesg D_80339BEC;
@@ -46,6 +63,10 @@ s8 gShowProfiler;
 s8 gShowDebugText;
 
 static struct AudioAPI *audio_api;
+#ifndef TARGET_N3DS
+static struct AudioResampler audio_resampler;
+static bool audio_resampler_active;
+#endif
 static struct GfxWindowManagerAPI *wm_api;
 static struct GfxRenderingAPI *rendering_api;
 
@@ -75,9 +96,35 @@ void send_display_list(struct SPTask *spTask) {
 #ifdef VERSION_EU
 #define SAMPLES_HIGH 656
 #define SAMPLES_LOW 640
+#define AUDIO_BUFFERS_PER_SECOND 50
 #else
 #define SAMPLES_HIGH 544
 #define SAMPLES_LOW 528
+#define AUDIO_BUFFERS_PER_SECOND 60
+#endif
+
+// Range the adaptive buffering may pick from, one granularity step beyond the legacy pair
+#define SAMPLES_MIN (SAMPLES_LOW - AUDIO_BUFFERING_GRANULARITY)
+#define SAMPLES_MAX (SAMPLES_HIGH + AUDIO_BUFFERING_GRANULARITY)
+
+#ifndef TARGET_N3DS
+static void print_audio_stats(void) {
+    static u32 frames;
+    const struct AudioBufferingStats *stats;
+
+    if (++frames < 5 * AUDIO_BUFFERS_PER_SECOND / 2) {
+        return;
+    }
+    frames = 0;
+    stats = audio_buffering_get_stats();
+    fprintf(stderr, "audio: %d frames buffered (%d-%d), %.1f ms latency, %u underruns, %u samples/buffer, drift %.2f\n",
+            stats->buffered, stats->bufferedMin, stats->bufferedMax, stats->latencyMs, stats->underruns,
+            stats->lastSamples, stats->drift);
+    fprintf(stderr, "notes: %d of %d in use, %u voices (peak %u), %u stolen while decaying, %u stolen while active, %u dropped\n",
+            gNotePoolStats.inUse, gNotePoolStats.capacity, gNotePoolStats.activeVoices, gNotePoolStats.peakVoices,
+            gNotePoolStats.stolenDecaying, gNotePoolStats.stolenActive, gNotePoolStats.dropped);
+    audio_buffering_reset_stats();
+}
 #endif
 
 void produce_one_frame(void) {
@@ -86,12 +133,22 @@ void produce_one_frame(void) {
 
 #ifndef TARGET_N3DS
     int samples_left = audio_api->buffered();
-    u32 num_audio_samples = samples_left < audio_api->get_desired_buffered() ? SAMPLES_HIGH : SAMPLES_LOW;
-    s16 audio_buffer[SAMPLES_HIGH * 2 * 2];
+    u32 num_audio_samples = audio_buffering_next_samples(samples_left, audio_api->get_desired_buffered());
+    s16 audio_buffer[SAMPLES_MAX * 2 * 2];
     for (int i = 0; i < 2; i++) {
         create_next_audio_buffer(audio_buffer + i * (num_audio_samples * 2), num_audio_samples);
     }
-    audio_api->play((u8 *)audio_buffer, 2 * num_audio_samples * 4);
+    if (audio_resampler_active) {
+        size_t num_output_frames;
+        const s16 *output = audio_resampler_process(&audio_resampler, audio_buffer, 2 * num_audio_samples,
+                                                    &num_output_frames);
+        audio_api->play((const u8 *)output, num_output_frames * 4);
+    } else {
+        audio_api->play((u8 *)audio_buffer, 2 * num_audio_samples * 4);
+    }
+    if (configAudioStats) {
+        print_audio_stats();
+    }
 #endif
 
     gfx_end_frame();
@@ -138,14 +195,78 @@ static void on_fullscreen_changed(bool is_now_fullscreen) {
     configFullscreen = is_now_fullscreen;
 }
 
+#ifndef TARGET_N3DS
+// Upper bound for main_pool_mb, so the pool's offsets still fit in its u32 sizes
+#define MAIN_POOL_MAX_MB 1024
+
+// Reserves address space for the main pool. The OS only backs pages with memory the
+// first time they're touched, so the pool grows in page sized chunks as the left and
+// right sides are used. Elsewhere an oversized reservation costs next to nothing, but
+// Windows charges all of it against the commit limit (RAM plus page file) up front:
+// the level pool takes all of the free space on every level load, so committing it as
+// the sides advance would commit nearly all of it anyway.
+static void *reserve_main_pool(size_t size) {
+#if defined(_WIN32) || defined(_WIN64)
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return addr != MAP_FAILED ? addr : NULL;
+#endif
+}
+#endif
+
+#ifdef MEMORY_STATS
+static void print_memory_stats(void) {
+    memory_stats_print(stderr);
+}
+#endif
+
 void main_func(void) {
     static u8 pool[DOUBLE_SIZE_ON_64_BIT(0x165000)] __attribute__ ((aligned(16)));
-    main_pool_init(pool, pool + sizeof(pool));
-    gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
+    u8 *poolStart = pool;
+    size_t poolSize = sizeof(pool);
 
     configfile_load(CONFIG_FILE);
     atexit(save_config);
 
+#ifndef TARGET_N3DS
+    if (configMainPoolMb != 0) {
+        size_t size = (size_t) (configMainPoolMb < MAIN_POOL_MAX_MB ? configMainPoolMb : MAIN_POOL_MAX_MB) << 20;
+
+        // A pool no larger than the built-in one isn't worth reserving
+        if (size > poolSize) {
+            u8 *reserved = reserve_main_pool(size);
+
+            if (reserved != NULL) {
+                poolStart = reserved;
+                poolSize = size;
+            }
+        }
+    }
+#endif
+    main_pool_init(poolStart, poolStart + poolSize);
+    gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
+#ifdef MEMORY_STATS
+    atexit(print_memory_stats);
+#endif
+
+#ifndef TARGET_N3DS
+    if (configAudioOutputRate != AUDIO_SYNTHESIS_RATE) {
+        audio_resampler_active = audio_resampler_init(&audio_resampler, AUDIO_SYNTHESIS_RATE, configAudioOutputRate);
+        if (!audio_resampler_active) {
+            // Unsupported ratio, so let the system mixer deal with it
+            configAudioOutputRate = AUDIO_SYNTHESIS_RATE;
+        }
+    }
+#endif
+
+#ifdef THREAD_POOL
+    // render_threads counts the main thread, which works along with the pool
+    if (configRenderThreads > 1) {
+        thread_pool_init(configRenderThreads - 1);
+    }
+#endif
+
 #ifdef TARGET_WEB
     emscripten_set_main_loop(em_main_loop, 0, 0);
     request_anim_frame(on_anim_frame);
@@ -205,6 +326,13 @@ void main_func(void) {
         audio_api = &audio_null;
     }
 
+#ifndef TARGET_N3DS
+    gAudioMaxNotes = configAudioMaxNotes;
+    gAudioReverbFullRate = configAudioReverbFullRate;
+    audio_buffering_init(configAudioLatencyMs, configAudioOutputRate,
+                         (float) AUDIO_SYNTHESIS_RATE / AUDIO_BUFFERS_PER_SECOND, SAMPLES_MIN, SAMPLES_MAX);
+#endif
+
     audio_init();
     sound_init();
 
@@ -0,0 +1,375 @@
+// replay.c - plays back a .m64 input file without a window and hashes the game state every frame.
+//
+// Built with 'make replay'. Boots the game from a blank save, feeds the inputs through the
+// recorded TAS controller, and after every frame hashes Mario's state, the object pool, the
+// random seed and the audio the frame produced. With -r the hashes are written to the trace
+// file; otherwise they are checked against it, and the first frame that differs is reported.
+// A trace recorded before a change that should not affect gameplay must still match after it.
+//
+// With -s, a save state is taken after the given frame and restored once the run is over, and
+// the frames after it are run again: they must hash the same as the first time. With -n, the
+// scene graph builds no display lists, like in the simulation library (src/pc/sim/sim.h), which
+// must not change the hashes either.
+//
+// Pointers are hashed as object pool slots or not at all, so a trace stays valid when code
+// or data move. That needs a 64-bit build: on 32-bit builds the object fields that hold
+// pointers share rawData with the others, and the hashes change with every relink.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "audio/external.h"
+#include "audio/load.h"
+#include "engine/behavior_script.h"
+#include "game/area.h"
+#include "game/game_init.h"
+#include "game/level_update.h"
+#include "game/memory.h"
+#include "game/object_list_processor.h"
+#include "game/rendering_graph_node.h"
+#include "pc/configfile.h"
+#include "pc/controller/controller_recorded_tas.h"
+#include "pc/gfx/gfx_pc.h"
+#include "pc/headless/headless.h"
+#include "pc/savestate/savestate.h"
+#ifdef THREAD_POOL
+#include "pc/thread_pool.h"
+#endif
+#include "pc/timer.h"
+
+static u32 sInputsRead;
+
+static void replay_init_input(void) {
+    controller_recorded_tas.init();
+}
+
+static void replay_read_input(OSContPad *pad) {
+    controller_recorded_tas.read(pad);
+    sInputsRead++;
+}
+
+static struct ControllerAPI sReplayController = { replay_init_input, replay_read_input };
+
+struct FrameHashes {
+    u64 mario;
+    u64 objects;
+    u64 audio;
+    u32 seed;
+};
+
+static const char *sComponentNames[] = { "mario", "objects", "audio", "random seed" };
+
+// 64-bit FNV-1a
+#define HASH_INIT 0xCBF29CE484222325ULL
+
+static u64 hash_bytes(u64 hash, const void *data, size_t size) {
+    const u8 *bytes = data;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+#define HASH_FIELD(hash, field) hash = hash_bytes(hash, &(field), sizeof(field))
+#define HASH_RANGE(hash, ptr, type, first, end) \
+    hash = hash_bytes(hash, (const u8 *) (ptr) + offsetof(type, first), offsetof(type, end) - offsetof(type, first))
+
+static s32 object_slot(struct Object *obj) {
+    if (obj >= gObjectPool && obj < gObjectPool + OBJECT_POOL_CAPACITY) {
+        return obj - gObjectPool;
+    }
+    return -1;
+}
+
+// Everything in MarioState but the pointers
+static u64 hash_mario(void) {
+    struct MarioState *m = &gMarioStates[0];
+    u64 hash = HASH_INIT;
+    s32 slot;
+
+    HASH_RANGE(hash, m, struct MarioState, unk00, wall);
+    HASH_RANGE(hash, m, struct MarioState, ceilHeight, waterLevel);
+    HASH_FIELD(hash, m->waterLevel);
+    HASH_RANGE(hash, m, struct MarioState, collidedObjInteractTypes, prevNumStarsForDialog);
+    HASH_FIELD(hash, m->prevNumStarsForDialog);
+    HASH_RANGE(hash, m, struct MarioState, peakHeight, unkC4);
+    HASH_FIELD(hash, m->unkC4);
+    slot = object_slot(m->heldObj);
+    HASH_FIELD(hash, slot);
+    slot = object_slot(m->riddenObj);
+    HASH_FIELD(hash, slot);
+    return hash;
+}
+
+static u64 hash_objects(void) {
+    u64 hash = HASH_INIT;
+    s32 i;
+
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        struct Object *obj = &gObjectPool[i];
+        s32 slot;
+
+        if (obj->activeFlags == ACTIVE_FLAG_DEACTIVATED) {
+            continue;
+        }
+        HASH_FIELD(hash, i);
+        HASH_FIELD(hash, obj->activeFlags);
+        HASH_FIELD(hash, obj->numCollidedObjs);
+        HASH_FIELD(hash, obj->collidedObjInteractTypes);
+        HASH_FIELD(hash, obj->rawData);
+        HASH_FIELD(hash, obj->bhvStackIndex);
+        HASH_FIELD(hash, obj->bhvDelayTimer);
+        HASH_RANGE(hash, obj, struct Object, hitboxRadius, hitboxDownOffset);
+        HASH_FIELD(hash, obj->hitboxDownOffset);
+        HASH_FIELD(hash, obj->header.gfx.node.flags);
+        HASH_FIELD(hash, obj->header.gfx.angle);
+        HASH_FIELD(hash, obj->header.gfx.pos);
+        HASH_FIELD(hash, obj->header.gfx.scale);
+        HASH_FIELD(hash, obj->header.gfx.unk38.animID);
+        HASH_FIELD(hash, obj->header.gfx.unk38.animFrame);
+        slot = object_slot(obj->parentObj);
+        HASH_FIELD(hash, slot);
+        slot = object_slot(obj->platform);
+        HASH_FIELD(hash, slot);
+    }
+    return hash;
+}
+
+// Runs a frame the way produce_one_frame does
+static void run_frame(struct FrameHashes *hashes) {
+    s16 audioBuffer[HEADLESS_AUDIO_BUFFER_LEN];
+    u32 numSamples;
+
+    game_loop_one_iteration();
+    numSamples = headless_produce_audio(audioBuffer);
+
+    hashes->mario = hash_mario();
+    hashes->objects = hash_objects();
+    hashes->audio = hash_bytes(HASH_INIT, audioBuffer, 2 * numSamples * 2 * sizeof(s16));
+    hashes->seed = random_get_seed();
+}
+
+// Returns the index of the first component that differs, or -1
+static s32 compare_hashes(const struct FrameHashes *a, const struct FrameHashes *b) {
+    if (a->mario != b->mario) {
+        return 0;
+    }
+    if (a->objects != b->objects) {
+        return 1;
+    }
+    if (a->audio != b->audio) {
+        return 2;
+    }
+    if (a->seed != b->seed) {
+        return 3;
+    }
+    return -1;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-r] [-f frames] [-j threads] [-s frame] [-n] <inputs.m64> <trace.txt>\n", name);
+    fprintf(stderr, "  -r  record the trace instead of checking against it\n");
+    fprintf(stderr, "  -f  number of frames to run, by default the number of inputs in the file\n");
+    fprintf(stderr, "  -j  threads for the per-frame work, like render_threads\n");
+    fprintf(stderr, "  -s  take a save state after this frame, and run the rest again from it at the end\n");
+    fprintf(stderr, "  -n  build no display lists, like the simulation library\n");
+}
+
+// The replay's own state that goes with a save state
+struct Snapshot {
+    void *data;
+    u32 size;
+    u32 frame;
+    u32 inputsRead;
+    struct HeadlessAudioClock audioClock;
+};
+
+static s32 take_snapshot(struct Snapshot *snapshot, u32 frame) {
+    u64 start = timer_now_ns();
+
+    snapshot->size = savestate_size();
+    snapshot->data = snapshot->size != 0 ? malloc(snapshot->size) : NULL;
+    if (snapshot->data == NULL || savestate_save(snapshot->data, snapshot->size) == 0) {
+        fprintf(stderr, "Save states aren't supported by this build\n");
+        return FALSE;
+    }
+    snapshot->frame = frame;
+    snapshot->inputsRead = sInputsRead;
+    snapshot->audioClock = gHeadlessAudioClock;
+    printf("Saved %u bytes after frame %u in %.3f ms\n", snapshot->size, frame, (timer_now_ns() - start) / 1e6);
+    return TRUE;
+}
+
+// Restores the snapshot and runs the frames after it again, checking them against the hashes
+// of the first run
+static s32 rerun_snapshot(const struct Snapshot *snapshot, const struct FrameHashes *hashes, u32 frames) {
+    u64 start = timer_now_ns();
+    u32 frame;
+
+    if (!savestate_load(snapshot->data, snapshot->size)) {
+        fprintf(stderr, "Couldn't load the save state\n");
+        return FALSE;
+    }
+    sInputsRead = snapshot->inputsRead;
+    gHeadlessAudioClock = snapshot->audioClock;
+    controller_recorded_tas_seek(sInputsRead);
+    printf("Loaded it in %.3f ms\n", (timer_now_ns() - start) / 1e6);
+
+    for (frame = snapshot->frame + 1; frame < frames; frame++) {
+        struct FrameHashes again;
+        s32 differs;
+
+        run_frame(&again);
+        differs = compare_hashes(&again, &hashes[frame]);
+        if (differs >= 0) {
+            printf("Frame %u after the save state: %s differs (level %d, area %d, action 0x%08x)\n", frame,
+                   sComponentNames[differs], gCurrLevelNum, gCurrAreaIndex, gMarioStates[0].action);
+            return FALSE;
+        }
+    }
+    printf("Matched %u frames after the save state\n", frames - snapshot->frame - 1);
+    return TRUE;
+}
+
+int main(int argc, char *argv[]) {
+    static u8 pool[DOUBLE_SIZE_ON_64_BIT(0x165000)] __attribute__((aligned(16)));
+    s32 record = FALSE;
+    u32 frames = 0;
+    u32 threads = 0;
+    s32 snapshotFrame = -1;
+    struct Snapshot snapshot;
+    struct FrameHashes *history = NULL;
+    const char *inputPath, *tracePath;
+    FILE *trace;
+    u32 frame;
+    u64 start, elapsed;
+    s32 i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-r") == 0) {
+            record = TRUE;
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            frames = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            snapshotFrame = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            gGeoSkipDisplayLists = TRUE;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - i != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    inputPath = argv[i];
+    tracePath = argv[i + 1];
+
+    trace = fopen(tracePath, record ? "w" : "r");
+    if (trace == NULL) {
+        perror(tracePath);
+        return 1;
+    }
+
+#ifdef WIDESCREEN
+    gfx_current_dimensions.width = SCREEN_WIDTH;
+    gfx_current_dimensions.height = SCREEN_HEIGHT;
+    gfx_current_dimensions.aspect_ratio = 4.0f / 3.0f;
+    gfx_current_dimensions.aspect_ratio_factor = 1.0f;
+#endif
+#ifdef THREAD_POOL
+    if (threads > 1) {
+        thread_pool_init(threads - 1);
+    }
+#else
+    (void) threads;
+#endif
+
+    // No config file is loaded, so the options that affect the simulation keep their defaults
+    gEepromFile = NULL;
+    main_pool_init(pool, pool + sizeof(pool));
+    gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
+    gAudioMaxNotes = configAudioMaxNotes;
+    gAudioReverbFullRate = configAudioReverbFullRate;
+    audio_init();
+    sound_init();
+
+    controller_recorded_tas_set_file(inputPath);
+    gHeadlessController = &sReplayController;
+    thread5_game_loop(NULL);
+    if (frames == 0) {
+        frames = controller_recorded_tas_samples();
+    }
+    if (frames == 0) {
+        fprintf(stderr, "%s: no inputs, pass the number of frames with -f\n", inputPath);
+        return 1;
+    }
+    if (snapshotFrame >= 0) {
+        if ((u32) snapshotFrame >= frames) {
+            fprintf(stderr, "Frame %d is past the end of the run\n", snapshotFrame);
+            return 1;
+        }
+        history = malloc(frames * sizeof(struct FrameHashes));
+    }
+
+    start = timer_now_ns();
+    for (frame = 0; frame < frames; frame++) {
+        struct FrameHashes hashes, expected;
+        s32 differs;
+
+        run_frame(&hashes);
+        if (history != NULL) {
+            history[frame] = hashes;
+            if (frame == (u32) snapshotFrame && !take_snapshot(&snapshot, frame)) {
+                return 1;
+            }
+        }
+        if (record) {
+            fprintf(trace, "%u %016llx %016llx %016llx %04x\n", frame, (unsigned long long) hashes.mario,
+                    (unsigned long long) hashes.objects, (unsigned long long) hashes.audio, hashes.seed);
+            continue;
+        }
+
+        {
+            unsigned long long mario, objects, audio;
+            u32 traceFrame, seed;
+
+            if (fscanf(trace, "%u %llx %llx %llx %x", &traceFrame, &mario, &objects, &audio, &seed) != 5
+                || traceFrame != frame) {
+                fprintf(stderr, "%s ends at frame %u\n", tracePath, frame);
+                return 1;
+            }
+            expected.mario = mario;
+            expected.objects = objects;
+            expected.audio = audio;
+            expected.seed = seed;
+        }
+        differs = compare_hashes(&hashes, &expected);
+        if (differs >= 0) {
+            printf("Frame %u: %s differs (level %d, area %d, action 0x%08x)\n", frame, sComponentNames[differs],
+                   gCurrLevelNum, gCurrAreaIndex, gMarioStates[0].action);
+            return 1;
+        }
+    }
+    elapsed = timer_now_ns() - start;
+    fclose(trace);
+
+    printf("%s %u frames in %.3f s (%.1f frames/s)\n", record ? "Recorded" : "Matched", frames, elapsed / 1e9,
+           frames / (elapsed / 1e9));
+
+    if (history != NULL && !rerun_snapshot(&snapshot, history, frames)) {
+        return 1;
+    }
+    return 0;
+}
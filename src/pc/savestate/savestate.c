@@ -0,0 +1,269 @@
+// savestate.c - snapshots of the whole game state.
+//
+// The game keeps its state in the globals of hundreds of files, so rather than listing them,
+// the Makefile links the game objects (src/game, src/engine, src/audio, src/menu, goddard and
+// the buffers they use) between savestate_begin.o and savestate_end.o, and a snapshot copies
+// everything in between, in the data and bss sections both. The rest of the state is in the
+// used parts of the main pool, and in the few bits of level data the game writes to.
+//
+// Caches of pointers into malloc'd memory and scratch buffers that are rewritten every frame
+// are left out, see the *_savestate_exclude functions. The ports' backends (graphics, audio,
+// controllers, thread pool) are linked outside of the range, so they're left alone too.
+
+#ifndef TARGET_N3DS
+
+#include <string.h>
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "buffers/buffers.h"
+#include "engine/behavior_script.h"
+#include "engine/geo_layout.h"
+#include "game/area.h"
+#include "game/game_init.h"
+#include "game/level_update.h"
+#include "game/object_list_processor.h"
+#include "game/paintings.h"
+#include "game/rendering_graph_node.h"
+#include "savestate.h"
+
+extern char gSaveStateDataBegin[], gSaveStateDataEnd[];
+extern char gSaveStateBssBegin[], gSaveStateBssEnd[];
+
+// The main pool, from memory.c
+extern u8 *sPoolStart;
+extern u8 *sPoolEnd;
+extern struct MainPoolBlock *sPoolListHeadL;
+extern struct MainPoolBlock *sPoolListHeadR;
+
+#define SAVESTATE_MAGIC 0x53363453 // "S64S"
+
+#define AREA_COUNT 8 // Size of gAreaData
+#define MAX_STATIC_REGIONS 64
+#define MAX_REGIONS (MAX_STATIC_REGIONS + 3 + AREA_COUNT)
+
+#define ALIGN16(val) (((val) + 0xF) & ~0xF)
+
+struct SaveStateRegion {
+    u8 *addr;
+    u32 size;
+};
+
+// Followed by every region as a SaveStateRegion and its contents, each padded to 16 bytes
+struct SaveStateHeader {
+    u32 magic;
+    u32 size;
+    u32 numRegions;
+    const char *anchor; // gSaveStateDataBegin, which is different in every build
+    u8 *poolStart;      // sPoolStart, which can be different in every run
+};
+
+#define HEADER_SIZE ALIGN16(sizeof(struct SaveStateHeader))
+#define REGION_SIZE ALIGN16(sizeof(struct SaveStateRegion))
+
+// The game's globals with the excluded parts cut out, and the level data that never moves
+static struct SaveStateRegion sStaticRegions[MAX_STATIC_REGIONS];
+static s32 sNumStaticRegions;
+static s32 sInitialized; // -1 if the game's globals aren't between the anchors
+
+static struct SaveStateRegion sRegions[MAX_REGIONS];
+static s32 sNumRegions;
+
+static s32 savestate_contains(const void *addr) {
+    const char *p = addr;
+
+    return (p >= gSaveStateDataBegin && p < gSaveStateDataEnd) || (p >= gSaveStateBssBegin && p < gSaveStateBssEnd);
+}
+
+static void savestate_add(struct SaveStateRegion *regions, s32 *count, s32 max, void *addr, u32 size) {
+    if (*count == max) {
+        sInitialized = -1;
+        return;
+    }
+    regions[*count].addr = addr;
+    regions[*count].size = size;
+    (*count)++;
+}
+
+static void savestate_include(void *addr, u32 size) {
+    savestate_add(sStaticRegions, &sNumStaticRegions, MAX_STATIC_REGIONS, addr, size);
+}
+
+static void savestate_exclude(void *addr, u32 size) {
+    u8 *start = addr;
+    u8 *end = start + size;
+    s32 i;
+
+    for (i = 0; i < sNumStaticRegions; i++) {
+        struct SaveStateRegion *region = &sStaticRegions[i];
+        u8 *regionEnd = region->addr + region->size;
+
+        if (start >= regionEnd || end <= region->addr) {
+            continue;
+        }
+        if (start > region->addr && end < regionEnd) {
+            // Split the region around the excluded part
+            savestate_include(end, regionEnd - end);
+            region->size = start - region->addr;
+        } else if (start > region->addr) {
+            region->size = start - region->addr;
+        } else {
+            region->addr = end < regionEnd ? end : regionEnd;
+            region->size = regionEnd - region->addr;
+        }
+    }
+}
+
+static void savestate_init(void) {
+    sInitialized = 1;
+
+    // If the linker didn't keep the game's globals together, a snapshot would miss some
+    if (!savestate_contains(gObjectPool) || !savestate_contains(gMarioStates) || !savestate_contains(gAudioHeap)
+        || !savestate_contains(&gGlobalTimer)) {
+        sInitialized = -1;
+        return;
+    }
+
+    savestate_include(gSaveStateDataBegin, gSaveStateDataEnd - gSaveStateDataBegin);
+    savestate_include(gSaveStateBssBegin, gSaveStateBssEnd - gSaveStateBssBegin);
+    savestate_exclude(gGfxPools, sizeof(gGfxPools));
+    bhv_savestate_exclude(savestate_exclude);
+    geo_layout_savestate_exclude(savestate_exclude);
+    geo_process_savestate_exclude(savestate_exclude);
+    display_list_pool_savestate_exclude(savestate_exclude);
+    painting_savestate_include(savestate_include);
+}
+
+// Size of a macro object list, up to and including the end marker (see spawn_macro_objects)
+static u32 macro_object_list_size(s16 *list) {
+    s16 *end = list;
+
+    while (*end != -1 && (*end & 0x1FF) >= 31) {
+        end += 5;
+    }
+    return (end - list + 1) * sizeof(s16);
+}
+
+static s32 savestate_collect(void) {
+    s32 i;
+
+    if (sInitialized == 0) {
+        savestate_init();
+    }
+    if (sInitialized < 0 || sPoolStart == NULL) {
+        return FALSE;
+    }
+
+    memcpy(sRegions, sStaticRegions, sNumStaticRegions * sizeof(struct SaveStateRegion));
+    sNumRegions = sNumStaticRegions;
+
+    // The used parts of the main pool, with the list heads at either end
+    savestate_add(sRegions, &sNumRegions, MAX_REGIONS, sPoolStart - 16,
+                  (u8 *) sPoolListHeadL + 16 - (sPoolStart - 16));
+    savestate_add(sRegions, &sNumRegions, MAX_REGIONS, sPoolListHeadR,
+                  sPoolEnd + 16 - (u8 *) sPoolListHeadR);
+
+    // The level data the game writes to: the water levels, and the respawn flags of the
+    // macro objects
+    if (gEnvironmentRegions != NULL) {
+        savestate_add(sRegions, &sNumRegions, MAX_REGIONS, gEnvironmentRegions,
+                      (1 + 6 * gEnvironmentRegions[0]) * sizeof(s16));
+    }
+    for (i = 0; i < AREA_COUNT; i++) {
+        if (gAreaData[i].macroObjects != NULL) {
+            savestate_add(sRegions, &sNumRegions, MAX_REGIONS, gAreaData[i].macroObjects,
+                          macro_object_list_size(gAreaData[i].macroObjects));
+        }
+    }
+    return sInitialized > 0;
+}
+
+static u32 savestate_total_size(void) {
+    u32 size = HEADER_SIZE;
+    s32 i;
+
+    for (i = 0; i < sNumRegions; i++) {
+        size += REGION_SIZE + ALIGN16(sRegions[i].size);
+    }
+    return size;
+}
+
+u32 savestate_size(void) {
+    if (!savestate_collect()) {
+        return 0;
+    }
+    return savestate_total_size();
+}
+
+u32 savestate_save(void *buffer, u32 size) {
+    struct SaveStateHeader *header = buffer;
+    u8 *pos = (u8 *) buffer + HEADER_SIZE;
+    u32 total;
+    s32 i;
+
+    if (!savestate_collect() || (total = savestate_total_size()) > size) {
+        return 0;
+    }
+
+    header->magic = SAVESTATE_MAGIC;
+    header->size = total;
+    header->numRegions = sNumRegions;
+    header->anchor = gSaveStateDataBegin;
+    header->poolStart = sPoolStart;
+    for (i = 0; i < sNumRegions; i++) {
+        memcpy(pos, &sRegions[i], sizeof(struct SaveStateRegion));
+        pos += REGION_SIZE;
+        memcpy(pos, sRegions[i].addr, sRegions[i].size);
+        pos += ALIGN16(sRegions[i].size);
+    }
+    return total;
+}
+
+// Returns the region at pos and moves pos to the next one, or returns NULL if the region
+// doesn't fit before end
+static const u8 *savestate_next_region(const u8 **pos, const u8 *end, struct SaveStateRegion *region) {
+    const u8 *data = *pos + REGION_SIZE;
+
+    if (data > end) {
+        return NULL;
+    }
+    memcpy(region, *pos, sizeof(struct SaveStateRegion));
+    if (region->size > (u32) (end - data)) {
+        return NULL;
+    }
+    *pos = data + ALIGN16(region->size);
+    return data;
+}
+
+s32 savestate_load(const void *buffer, u32 size) {
+    const struct SaveStateHeader *header = buffer;
+    struct SaveStateRegion region;
+    const u8 *pos, *end;
+    u32 i;
+
+    if (size < HEADER_SIZE || header->magic != SAVESTATE_MAGIC || header->size > size
+        || header->anchor != gSaveStateDataBegin || header->poolStart != sPoolStart) {
+        return FALSE;
+    }
+
+    // Check the whole snapshot first, so a bad one doesn't leave the state half restored
+    end = (const u8 *) buffer + header->size;
+    pos = (const u8 *) buffer + HEADER_SIZE;
+    for (i = 0; i < header->numRegions; i++) {
+        if (savestate_next_region(&pos, end, &region) == NULL) {
+            return FALSE;
+        }
+    }
+
+    pos = (const u8 *) buffer + HEADER_SIZE;
+    for (i = 0; i < header->numRegions; i++) {
+        const u8 *data = savestate_next_region(&pos, end, &region);
+
+        memcpy(region.addr, data, region.size);
+    }
+    return TRUE;
+}
+
+#endif
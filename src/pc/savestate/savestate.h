@@ -0,0 +1,21 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <PR/ultratypes.h>
+
+// Snapshots of the whole game state, taken and restored with memcpy: the globals of the game
+// code, the used parts of the main pool, and the level data the game writes to. Snapshots
+// hold pointers, so they can only be restored in the same run of the game that took them,
+// between two frames. Not available on 3DS.
+
+// Size of a snapshot of the current state. It changes as the main pool fills up, and is 0
+// if the build doesn't support save states.
+u32 savestate_size(void);
+
+// Writes a snapshot to buffer and returns its size, or 0 if it doesn't fit in size bytes.
+u32 savestate_save(void *buffer, u32 size);
+
+// Restores a snapshot. Returns FALSE if buffer doesn't hold one from this run of the game.
+s32 savestate_load(const void *buffer, u32 size);
+
+#endif
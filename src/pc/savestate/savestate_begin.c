@@ -0,0 +1,5 @@
+// Linked right before the game objects, so these mark where their globals start.
+// See savestate.c.
+
+char gSaveStateDataBegin[1] = { 1 };
+char gSaveStateBssBegin[1];
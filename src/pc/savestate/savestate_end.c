@@ -0,0 +1,5 @@
+// Linked right after the game objects, so these mark where their globals end.
+// See savestate.c.
+
+char gSaveStateDataEnd[1] = { 1 };
+char gSaveStateBssEnd[1];
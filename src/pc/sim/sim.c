@@ -0,0 +1,97 @@
+// sim.c - the game logic as a library, see sim.h.
+//
+// Takes the place of pc_main.c and the controller and graphics backends: the inputs come from
+// sim_step, the display lists are dropped, and the audio is only run when asked for.
+
+#ifndef TARGET_N3DS
+
+#include <ultra64.h>
+#include "sm64.h"
+#include "types.h"
+
+#include "audio/external.h"
+#include "audio/load.h"
+#include "engine/math_util.h"
+#include "game/area.h"
+#include "game/game_init.h"
+#include "game/level_update.h"
+#include "game/memory.h"
+#include "game/rendering_graph_node.h"
+#include "pc/gfx/gfx_pc.h"
+#include "pc/headless/headless.h"
+#include "sim.h"
+
+#ifdef WIDESCREEN
+// From gfx_pc.c, for the HUD's positions
+struct GfxDimensions gfx_current_dimensions;
+#endif
+
+static struct SimInput sInput;
+static s32 sAudioEnabled;
+
+static void sim_read_input(OSContPad *pad) {
+    pad->button = sInput.buttons;
+    pad->stick_x = sInput.stickX;
+    pad->stick_y = sInput.stickY;
+}
+
+static struct ControllerAPI sSimController = { NULL, sim_read_input };
+
+void sim_init(void) {
+    static u8 pool[DOUBLE_SIZE_ON_64_BIT(0x165000)] __attribute__((aligned(16)));
+
+#ifdef WIDESCREEN
+    gfx_current_dimensions.width = SCREEN_WIDTH;
+    gfx_current_dimensions.height = SCREEN_HEIGHT;
+    gfx_current_dimensions.aspect_ratio = 4.0f / 3.0f;
+    gfx_current_dimensions.aspect_ratio_factor = 1.0f;
+#endif
+
+    // The save file is kept in memory, so simulations don't touch each other's saves
+    gEepromFile = NULL;
+    gGeoSkipDisplayLists = TRUE;
+    gHeadlessController = &sSimController;
+    main_pool_init(pool, pool + sizeof(pool));
+    gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
+    audio_init();
+    sound_init();
+    thread5_game_loop(NULL);
+}
+
+void sim_set_audio(s32 enable) {
+    sAudioEnabled = enable;
+}
+
+void sim_step(const struct SimInput *inputs, u32 numFrames) {
+    s16 audioBuffer[HEADLESS_AUDIO_BUFFER_LEN];
+    u32 frame;
+
+    for (frame = 0; frame < numFrames; frame++) {
+        sInput = inputs[frame];
+        game_loop_one_iteration();
+        if (sAudioEnabled) {
+            headless_produce_audio(audioBuffer);
+        }
+    }
+}
+
+void sim_get_mario_state(struct SimMarioState *state) {
+    struct MarioState *m = &gMarioStates[0];
+
+    state->action = m->action;
+    state->actionState = m->actionState;
+    state->actionTimer = m->actionTimer;
+    vec3f_copy(state->pos, m->pos);
+    vec3f_copy(state->vel, m->vel);
+    state->forwardVel = m->forwardVel;
+    vec3s_copy(state->faceAngle, m->faceAngle);
+    state->health = m->health;
+    state->numCoins = m->numCoins;
+    state->numStars = m->numStars;
+    state->numLives = m->numLives;
+    state->levelNum = gCurrLevelNum;
+    state->areaIndex = gCurrAreaIndex;
+    state->globalTimer = gGlobalTimer;
+}
+
+#endif
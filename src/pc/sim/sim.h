@@ -0,0 +1,58 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <PR/ultratypes.h>
+
+// The game logic without a window or any graphics, audio or controller backend, for tools that
+// run many simulations (TAS search, route checks). 'make sim' builds libsm64sim.a; link it with
+// -lm -lpthread. Not available on 3DS.
+//
+// A frame runs the level scripts, the objects, Mario and the camera the same way the game does,
+// but the scene graph builds no display lists and no audio is synthesized unless asked for.
+//
+// The game's state is global, so this library runs one game at a time. For several independent
+// games in one process that can run at the same time, load a copy of the library per game with
+// sim_instance.h. To switch one game between several states instead, keep a save state of each
+// (see src/pc/savestate/savestate.h) and load the one to step next.
+
+struct SimInput {
+    u16 buttons; // Like A_BUTTON | Z_TRIG
+    s8 stickX;
+    s8 stickY;
+};
+
+struct SimMarioState {
+    u32 action;
+    u16 actionState;
+    u16 actionTimer;
+    f32 pos[3];
+    f32 vel[3];
+    f32 forwardVel;
+    s16 faceAngle[3];
+    s16 health;
+    s16 numCoins;
+    s16 numStars;
+    s8 numLives;
+    s16 levelNum;
+    s16 areaIndex;
+    u32 globalTimer;
+};
+
+// Boots the game from a blank save. Call it once, before the rest.
+void sim_init(void);
+
+// Synthesizes the audio of every frame and drops it, so the sequence players advance as they do
+// in the game. The game logic never reads their state, so this is off by default.
+void sim_set_audio(s32 enable);
+
+// Runs numFrames frames, reading inputs[i] on frame i.
+void sim_step(const struct SimInput *inputs, u32 numFrames);
+
+void sim_get_mario_state(struct SimMarioState *state);
+
+// Reads the inputs of controller 1 from a .m64 file. Returns an array of *numInputs inputs to
+// free(), or NULL after printing why to stderr. Built as sim_m64.o, which tools that use
+// sim_instance.h link on their own.
+struct SimInput *sim_load_m64(const char *path, u32 *numInputs);
+
+#endif
@@ -0,0 +1,111 @@
+// sim_instance.c - loads a copy of libsm64sim.so per game, see sim_instance.h.
+//
+// The dynamic loader hands out the same copy every time a file is opened again, so every
+// instance opens a fresh copy of the library from a temporary file. The library is linked with
+// -Bsymbolic, so each copy's code uses its own globals even though they all have the same names.
+
+#if !defined(TARGET_N3DS) && !defined(_WIN32)
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim_instance.h"
+
+// Copies the file at src to a new temporary file and returns its path, or NULL
+static char *copy_to_temp_file(const char *src) {
+    const char *tmpDir = getenv("TMPDIR");
+    char buf[65536];
+    FILE *in, *out;
+    char *path;
+    size_t len;
+    s32 failed = FALSE;
+    int fd;
+
+    if (tmpDir == NULL || tmpDir[0] == '\0') {
+        tmpDir = "/tmp";
+    }
+    path = malloc(strlen(tmpDir) + sizeof("/libsm64sim-XXXXXX"));
+    if (path == NULL) {
+        return NULL;
+    }
+    sprintf(path, "%s/libsm64sim-XXXXXX", tmpDir);
+
+    in = fopen(src, "rb");
+    if (in == NULL) {
+        perror(src);
+        free(path);
+        return NULL;
+    }
+    fd = mkstemp(path);
+    out = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (out == NULL) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        fclose(in);
+        free(path);
+        return NULL;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), in)) > 0) {
+        if (fwrite(buf, 1, len, out) != len) {
+            failed = TRUE;
+            break;
+        }
+    }
+    if (fclose(out) != 0 || failed || ferror(in)) {
+        perror(path);
+        fclose(in);
+        unlink(path);
+        free(path);
+        return NULL;
+    }
+    fclose(in);
+    return path;
+}
+
+#define LOAD_SYMBOL(field, name)                                                                       \
+    if ((*(void **) &instance->field = dlsym(instance->handle, name)) == NULL) {                       \
+        fprintf(stderr, "%s: no %s\n", libraryPath, name);                                             \
+        sim_instance_destroy(instance);                                                                \
+        return FALSE;                                                                                  \
+    }
+
+s32 sim_instance_create(struct SimInstance *instance, const char *libraryPath) {
+    char *copy = copy_to_temp_file(libraryPath);
+
+    memset(instance, 0, sizeof(*instance));
+    if (copy == NULL) {
+        return FALSE;
+    }
+    instance->handle = dlopen(copy, RTLD_NOW | RTLD_LOCAL);
+    // The copy stays mapped, so the file isn't needed anymore
+    unlink(copy);
+    free(copy);
+    if (instance->handle == NULL) {
+        fprintf(stderr, "%s\n", dlerror());
+        return FALSE;
+    }
+
+    LOAD_SYMBOL(init, "sim_init");
+    LOAD_SYMBOL(set_audio, "sim_set_audio");
+    LOAD_SYMBOL(step, "sim_step");
+    LOAD_SYMBOL(get_mario_state, "sim_get_mario_state");
+    LOAD_SYMBOL(savestate_size, "savestate_size");
+    LOAD_SYMBOL(savestate_save, "savestate_save");
+    LOAD_SYMBOL(savestate_load, "savestate_load");
+    return TRUE;
+}
+
+void sim_instance_destroy(struct SimInstance *instance) {
+    if (instance->handle != NULL) {
+        dlclose(instance->handle);
+    }
+    memset(instance, 0, sizeof(*instance));
+}
+
+#endif
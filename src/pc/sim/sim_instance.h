@@ -0,0 +1,40 @@
+#ifndef SIM_INSTANCE_H
+#define SIM_INSTANCE_H
+
+#include <PR/ultratypes.h>
+
+#include "sim.h"
+
+// Independent games in one process. Build with SIM_INSTANCES=1 and 'make sim_shared', which
+// links the simulation library as libsm64sim.so, and compile this file into the tool with -ldl.
+//
+// Every instance loads its own copy of the library, and with it its own copy of all of the
+// game's globals, so instances share no state and can be stepped on different threads at the
+// same time. Save states taken by one instance can only be loaded by the same instance.
+// Not available on 3DS or Windows.
+//
+// Nothing is shared between instances. Each copy is loaded from its own temporary file, so
+// its code and the game's data take their own pages, as does the file itself when the
+// temporary directory is in memory. Each copy also has its own globals, about 6 MiB on 64-bit
+// builds: the 2.8 MiB main pool, 1.9 MiB of audio heap and display list buffers, and
+// 1392 bytes per object slot, or 0.3 MiB with the default OBJECT_POOL_CAPACITY. Multiply the
+// size of libsm64sim.so plus these by the number of instances to size them.
+
+struct SimInstance {
+    void *handle;
+    void (*init)(void);
+    void (*set_audio)(s32 enable);
+    void (*step)(const struct SimInput *inputs, u32 numFrames);
+    void (*get_mario_state)(struct SimMarioState *state);
+    u32 (*savestate_size)(void);
+    u32 (*savestate_save)(void *buffer, u32 size);
+    s32 (*savestate_load)(const void *buffer, u32 size);
+};
+
+// Loads a new copy of the library at libraryPath into instance. The game still has to be
+// booted with instance->init. Returns FALSE, after printing why to stderr, if it fails.
+s32 sim_instance_create(struct SimInstance *instance, const char *libraryPath);
+
+void sim_instance_destroy(struct SimInstance *instance);
+
+#endif
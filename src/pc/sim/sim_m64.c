@@ -0,0 +1,53 @@
+// sim_m64.c - reads the inputs of a .m64 file for the simulation tools, see sim.h.
+//
+// Kept out of sim.c so that tools that load the library per instance, like sim_bench, can link
+// it on its own.
+
+#ifndef TARGET_N3DS
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+// Same layout as controller_recorded_tas.c reads
+#define M64_HEADER_SIZE 0x400
+#define M64_NUM_SAMPLES 0x18
+
+struct SimInput *sim_load_m64(const char *path, u32 *numInputs) {
+    u8 header[M64_HEADER_SIZE];
+    u8 sample[4];
+    struct SimInput *inputs;
+    FILE *fp = fopen(path, "rb");
+    u32 count;
+    u32 i;
+
+    if (fp == NULL) {
+        perror(path);
+        return NULL;
+    }
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header)) {
+        fprintf(stderr, "%s: not a .m64 file\n", path);
+        fclose(fp);
+        return NULL;
+    }
+    count = header[M64_NUM_SAMPLES] | (header[M64_NUM_SAMPLES + 1] << 8)
+            | (header[M64_NUM_SAMPLES + 2] << 16) | ((u32) header[M64_NUM_SAMPLES + 3] << 24);
+    inputs = calloc(count != 0 ? count : 1, sizeof(struct SimInput));
+    if (inputs == NULL) {
+        fprintf(stderr, "%s: out of memory for %u inputs\n", path, count);
+        fclose(fp);
+        return NULL;
+    }
+    // A file cut short keeps the inputs it has
+    for (i = 0; i < count && fread(sample, 1, sizeof(sample), fp) == sizeof(sample); i++) {
+        inputs[i].buttons = (sample[0] << 8) | sample[1];
+        inputs[i].stickX = sample[2];
+        inputs[i].stickY = sample[3];
+    }
+    fclose(fp);
+    *numInputs = i;
+    return inputs;
+}
+
+#endif
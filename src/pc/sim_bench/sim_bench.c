@@ -0,0 +1,125 @@
+// sim_bench.c - runs many independent games at once in one process.
+//
+// Built with 'make SIM_INSTANCES=1 sim_bench'. Loads an instance of libsm64sim.so per thread
+// (see src/pc/sim/sim_instance.h), plays the same .m64 inputs on all of them at the same time,
+// and prints the frames per second of all of them together. The instances must not see each
+// other's state, so they must all end up with the same Mario state as a single instance run
+// on its own.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pc/sim/sim_instance.h"
+#include "pc/timer.h"
+
+#define MAX_INSTANCES 256
+
+struct BenchThread {
+    pthread_t thread;
+    const char *libraryPath;
+    const struct SimInput *inputs;
+    u32 frames;
+    s32 ok;
+    struct SimMarioState result;
+};
+
+static void *run_instance(void *arg) {
+    struct BenchThread *bench = arg;
+    struct SimInstance instance;
+
+    if (!sim_instance_create(&instance, bench->libraryPath)) {
+        return NULL;
+    }
+    instance.init();
+    instance.step(bench->inputs, bench->frames);
+    // Cleared first so the padding compares equal too
+    memset(&bench->result, 0, sizeof(bench->result));
+    instance.get_mario_state(&bench->result);
+    sim_instance_destroy(&instance);
+    bench->ok = TRUE;
+    return NULL;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-n instances] [-f frames] <libsm64sim.so> <inputs.m64>\n", name);
+    fprintf(stderr, "  -n  number of instances, each on its own thread, 4 by default\n");
+    fprintf(stderr, "  -f  number of frames to run, by default the number of inputs in the file\n");
+}
+
+int main(int argc, char *argv[]) {
+    static struct BenchThread threads[MAX_INSTANCES + 1];
+    u32 numInstances = 4;
+    u32 frames = 0;
+    u32 numInputs;
+    struct SimInput *inputs;
+    struct BenchThread *single = &threads[MAX_INSTANCES];
+    u64 start, singleTime, allTime;
+    u32 i;
+    s32 arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            numInstances = strtoul(argv[++arg], NULL, 0);
+        } else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) {
+            frames = strtoul(argv[++arg], NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - arg != 2 || numInstances == 0 || numInstances > MAX_INSTANCES) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    inputs = sim_load_m64(argv[arg + 1], &numInputs);
+    if (inputs == NULL) {
+        return 1;
+    }
+    if (frames == 0 || frames > numInputs) {
+        frames = numInputs;
+    }
+
+    // One instance on its own first, for the expected result and the speed of a single game
+    single->libraryPath = argv[arg];
+    single->inputs = inputs;
+    single->frames = frames;
+    start = timer_now_ns();
+    run_instance(single);
+    singleTime = timer_now_ns() - start;
+    if (!single->ok) {
+        return 1;
+    }
+
+    start = timer_now_ns();
+    for (i = 0; i < numInstances; i++) {
+        threads[i] = *single;
+        threads[i].ok = FALSE;
+        pthread_create(&threads[i].thread, NULL, run_instance, &threads[i]);
+    }
+    for (i = 0; i < numInstances; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+    allTime = timer_now_ns() - start;
+
+    for (i = 0; i < numInstances; i++) {
+        if (!threads[i].ok) {
+            return 1;
+        }
+        if (memcmp(&threads[i].result, &single->result, sizeof(struct SimMarioState)) != 0) {
+            printf("Instance %u ended in a different state (action 0x%08x, level %d) than when run alone "
+                   "(action 0x%08x, level %d)\n",
+                   i, threads[i].result.action, threads[i].result.levelNum, single->result.action,
+                   single->result.levelNum);
+            return 1;
+        }
+    }
+
+    printf("1 instance: %u frames in %.3f s (%.1f frames/s)\n", frames, singleTime / 1e9,
+           frames / (singleTime / 1e9));
+    printf("%u instances: %u frames in %.3f s (%.1f frames/s)\n", numInstances, numInstances * frames,
+           allTime / 1e9, numInstances * frames / (allTime / 1e9));
+    return 0;
+}
@@ -0,0 +1,104 @@
+#ifdef THREAD_POOL
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "thread_pool.h"
+
+#define MAX_THREADS 16
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    pthread_t threads[MAX_THREADS];
+    int numThreads;
+    unsigned int generation; // Bumped for every thread_pool_run
+    int busy;                // Workers still in the current run
+    ThreadPoolTask task;
+    void *arg;
+    int count;
+    int next; // Next index to hand out, taken with an atomic add
+} sPool;
+
+static void run_tasks(void) {
+    int index;
+
+    while ((index = __atomic_fetch_add(&sPool.next, 1, __ATOMIC_RELAXED)) < sPool.count) {
+        sPool.task(sPool.arg, index);
+    }
+}
+
+static void *worker_main(void *unused) {
+    unsigned int generation = 0;
+
+    (void) unused;
+    pthread_mutex_lock(&sPool.lock);
+    for (;;) {
+        while (sPool.generation == generation) {
+            pthread_cond_wait(&sPool.start, &sPool.lock);
+        }
+        generation = sPool.generation;
+        pthread_mutex_unlock(&sPool.lock);
+
+        run_tasks();
+
+        pthread_mutex_lock(&sPool.lock);
+        if (--sPool.busy == 0) {
+            pthread_cond_signal(&sPool.done);
+        }
+    }
+    return NULL;
+}
+
+void thread_pool_init(int numThreads) {
+    int i;
+
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+    pthread_mutex_init(&sPool.lock, NULL);
+    pthread_cond_init(&sPool.start, NULL);
+    pthread_cond_init(&sPool.done, NULL);
+    for (i = 0; i < numThreads; i++) {
+        if (pthread_create(&sPool.threads[i], NULL, worker_main, NULL) != 0) {
+            break;
+        }
+    }
+    sPool.numThreads = i;
+}
+
+int thread_pool_size(void) {
+    return sPool.numThreads;
+}
+
+void thread_pool_run(ThreadPoolTask task, void *arg, int count) {
+    if (sPool.numThreads == 0 || count <= 1) {
+        int i;
+
+        for (i = 0; i < count; i++) {
+            task(arg, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&sPool.lock);
+    sPool.task = task;
+    sPool.arg = arg;
+    sPool.count = count;
+    sPool.next = 0;
+    sPool.busy = sPool.numThreads;
+    sPool.generation++;
+    pthread_cond_broadcast(&sPool.start);
+    pthread_mutex_unlock(&sPool.lock);
+
+    run_tasks();
+
+    pthread_mutex_lock(&sPool.lock);
+    while (sPool.busy != 0) {
+        pthread_cond_wait(&sPool.done, &sPool.lock);
+    }
+    pthread_mutex_unlock(&sPool.lock);
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// A fixed set of worker threads for splitting per-frame work, like evaluating object
+// transforms, across cores. The calling thread works along with the pool, so a pool
+// of N threads runs N + 1 tasks at a time. Built when THREAD_POOL is defined (desktop builds).
+
+typedef void (*ThreadPoolTask)(void *arg, int index);
+
+// Starts numThreads workers. With 0 (or if no thread could be started), thread_pool_run
+// runs everything on the calling thread.
+void thread_pool_init(int numThreads);
+
+// Number of worker threads, not counting the caller.
+int thread_pool_size(void);
+
+// Calls task(arg, i) for every i in [0, count) and returns once all calls have finished.
+void thread_pool_run(ThreadPoolTask task, void *arg, int count);
+
+#endif
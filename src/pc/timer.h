@@ -0,0 +1,16 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <time.h>
+
+#include <PR/ultratypes.h>
+
+// Monotonic timestamp in nanoseconds, for the audio profiler and the benchmark tools of desktop
+// builds. Defined in the header so the tools don't have to link anything for it.
+static inline u64 timer_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64) ts.tv_sec * 1000000000ULL + (u64) ts.tv_nsec;
+}
+
+#endif
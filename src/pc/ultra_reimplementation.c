@@ -117,6 +117,13 @@ s32 osAiSetFrequency(u32 freq) {
     return D_8033491C / (s32) a1;
 }
 
+#ifndef TARGET_WEB
+// The file the EEPROM is kept in. Tools that need a known starting state, like sm64_replay,
+// set this to NULL to keep the EEPROM in memory instead, starting out blank.
+const char *gEepromFile = "sm64_save_file.bin";
+static u8 sEepromMemory[512];
+#endif
+
 s32 osEepromProbe(UNUSED OSMesgQueue *mq) {
     return 1;
 }
@@ -146,7 +153,11 @@ s32 osEepromLongRead(UNUSED OSMesgQueue *mq, u8 address, u8 *buffer, int nbytes)
         ret = 0;
     }
 #else
-    FILE *fp = fopen("sm64_save_file.bin", "rb");
+    if (gEepromFile == NULL) {
+        memcpy(buffer, sEepromMemory + address * 8, nbytes);
+        return 0;
+    }
+    FILE *fp = fopen(gEepromFile, "rb");
     if (fp == NULL) {
         return -1;
     }
@@ -176,7 +187,11 @@ s32 osEepromLongWrite(UNUSED OSMesgQueue *mq, u8 address, u8 *buffer, int nbytes
     }, content);
     s32 ret = 0;
 #else
-    FILE* fp = fopen("sm64_save_file.bin", "wb");
+    if (gEepromFile == NULL) {
+        memcpy(sEepromMemory, content, 512);
+        return 0;
+    }
+    FILE* fp = fopen(gEepromFile, "wb");
     if (fp == NULL) {
         return -1;
     }
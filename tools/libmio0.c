@@ -16,45 +16,50 @@
 #define GET_BIT(buf, bit) ((buf)[(bit) / 8] & (1 << (7 - ((bit) % 8))))
 
 // types
+
+// hash chains over every position of the input that has 3 bytes after it
 typedef struct
 {
-   int *indexes;
-   int allocated;
-   int count;
-   int start;
-} lookback;
+   int *head; // most recent position for each hash, or -1
+   int *prev; // previous position with the same hash, or -1
+} match_finder;
 
 // functions
-#define LOOKBACK_COUNT 256
-#define LOOKBACK_INIT_SIZE 128
-static lookback *lookback_init(void)
-{
-   lookback *lb = malloc(LOOKBACK_COUNT * sizeof(*lb));
-   for (int i = 0; i < LOOKBACK_COUNT; i++) {
-      lb[i].allocated = LOOKBACK_INIT_SIZE;
-      lb[i].indexes = malloc(lb[i].allocated * sizeof(*lb[i].indexes));
-      lb[i].count = 0;
-      lb[i].start = 0;
-   }
-   return lb;
+#define HASH_BITS 15
+#define HASH3(BUF_, IDX_) \
+   (((((unsigned int)(BUF_)[IDX_] << 16) | ((BUF_)[(IDX_) + 1] << 8) | (BUF_)[(IDX_) + 2]) * 2654435761u) >> (32 - HASH_BITS))
+
+// longest back-reference MIO0 can encode
+#define MAX_MATCH 18
+// farthest back-reference MIO0 can encode
+#define MAX_DISTANCE 4096
+
+static match_finder *match_finder_init(unsigned int length)
+{
+   match_finder *mf = malloc(sizeof(*mf));
+   mf->head = malloc((1 << HASH_BITS) * sizeof(*mf->head));
+   mf->prev = malloc((length + 1) * sizeof(*mf->prev));
+   memset(mf->head, 0xFF, (1 << HASH_BITS) * sizeof(*mf->head));
+   return mf;
 }
 
-static void lookback_free(lookback *lb)
+static void match_finder_free(match_finder *mf)
 {
-   for (int i = 0; i < LOOKBACK_COUNT; i++) {
-      free(lb[i].indexes);
-   }
-   free(lb);
+   free(mf->head);
+   free(mf->prev);
+   free(mf);
 }
 
-static inline void lookback_push(lookback *lkbk, unsigned char val, int index)
+// positions must be pushed in increasing order
+static inline void match_finder_push(match_finder *mf, const unsigned char *buf, unsigned int length, int index)
 {
-   lookback *lb = &lkbk[val];
-   if (lb->count == lb->allocated) {
-      lb->allocated *= 4;
-      lb->indexes = realloc(lb->indexes, lb->allocated * sizeof(*lb->indexes));
+   if (index + 2 < (int)length) {
+      unsigned int hash = HASH3(buf, index);
+      mf->prev[index] = mf->head[hash];
+      mf->head[hash] = index;
+   } else {
+      mf->prev[index] = -1;
    }
-   lb->indexes[lb->count++] = index;
 }
 
 static void PUT_BIT(unsigned char *buf, int bit, int val)
@@ -69,54 +74,41 @@ static void PUT_BIT(unsigned char *buf, int bit, int val)
 // start_offset: offset in buf to look back from
 // max_search: max number of bytes to find
 // found_offset: returned offset found (0 if none found)
-// returns max length of matching stream (0 if none found)
-static int find_longest(const unsigned char *buf, int start_offset, int max_search, int *found_offset, lookback *lkbk)
+// farthest_ties: among equally long matches, return the farthest one like the original encoder,
+//                instead of stopping at the first one of max_search bytes
+// returns max length of matching stream, or 0 if there is none of at least 3 bytes
+static int find_longest(const unsigned char *buf, int start_offset, int max_search, int *found_offset,
+                        const match_finder *mf, int farthest_ties)
 {
    int best_length = 0;
    int best_offset = 0;
-   int cur_length;
-   int search_len;
-   int farthest, off, i;
-   int lb_idx;
-   const unsigned char first = buf[start_offset];
-   lookback *lb = &lkbk[first];
-
-   // buf
-   //  |    off        start                  max
-   //  V     |+i->       |+i->                 |
-   //  |--------------raw-data-----------------|
-   //        |+i->       |      |+i->
-   //                       +cur_length
-
-   // check at most the past 4096 values
-   farthest = MAX(start_offset - 4096, 0);
-   // find starting index
-   for (lb_idx = lb->start; lb_idx < lb->count && lb->indexes[lb_idx] < farthest; lb_idx++) {}
-   lb->start = lb_idx;
-   for ( ; lb_idx < lb->count && lb->indexes[lb_idx] < start_offset; lb_idx++) {
-      off = lb->indexes[lb_idx];
-      // check at most requested max or up until start
-      search_len = MIN(max_search, start_offset - off);
-      for (i = 0; i < search_len; i++) {
-         if (buf[start_offset + i] != buf[off + i]) {
-            break;
-         }
+   int farthest;
+   int off;
+
+   *found_offset = 0;
+   if (max_search < 3) {
+      return 0;
+   }
+
+   // check at most the past 4096 values, nearest first; the chain may include
+   // hash collisions, which simply match fewer than 3 bytes
+   farthest = MAX(start_offset - MAX_DISTANCE, 0);
+   for (off = mf->head[HASH3(buf, start_offset)]; off >= farthest; off = mf->prev[off]) {
+      int cur_length = 0;
+      // can't beat or tie the best match unless the byte ending it matches
+      if (best_length > 0 && buf[start_offset + best_length - 1] != buf[off + best_length - 1]) {
+         continue;
       }
-      cur_length = i;
-      // if matched up until start, continue matching in already matched parts
-      if (cur_length == search_len) {
-         // check at most requested max less current length
-         search_len = max_search - cur_length;
-         for (i = 0; i < search_len; i++) {
-            if (buf[start_offset + cur_length + i] != buf[off + i]) {
-               break;
-            }
-         }
-         cur_length += i;
+      // a match can run past start_offset, repeating the bytes in between
+      while (cur_length < max_search && buf[start_offset + cur_length] == buf[off + cur_length]) {
+         cur_length++;
       }
-      if (cur_length > best_length) {
+      if (cur_length >= 3 && cur_length >= best_length) {
          best_offset = start_offset - off;
          best_length = cur_length;
+         if (best_length == max_search && !farthest_ties) {
+            break;
+         }
       }
    }
 
@@ -146,13 +138,52 @@ void mio0_encode_header(unsigned char *buf, const mio0_header_t *head)
    write_u32_be(&buf[12], head->uncomp_offset);
 }
 
+// copy a back-reference of length bytes from dist bytes behind out
+static inline void copy_backref(unsigned char *out, unsigned int dist, unsigned int length)
+{
+   const unsigned char *src = out - dist;
+   if (dist >= length) {
+      memcpy(out, src, length);
+   } else if (dist == 1) {
+      memset(out, src[0], length);
+   } else {
+      // source overlaps destination, which repeats the last dist bytes;
+      // copy them a period at a time so each copy is disjoint
+      while (length > dist) {
+         memcpy(out, src, dist);
+         out += dist;
+         length -= dist;
+      }
+      memcpy(out, src, length);
+   }
+}
+
+// number of consecutive 1 bits at the top of the word
+static inline int leading_ones(unsigned int bits)
+{
+#if defined(__GNUC__)
+   return ~bits == 0 ? 32 : __builtin_clz(~bits);
+#else
+   int count = 0;
+   while (bits & 0x80000000) {
+      bits <<= 1;
+      count++;
+   }
+   return count;
+#endif
+}
+
+// layout bits are consumed a big-endian word at a time, runs of uncompressed
+// bytes are copied together and back-references are copied with memcpy
 int mio0_decode(const unsigned char *in, unsigned char *out, unsigned int *end)
 {
    mio0_header_t head;
+   const unsigned char *layout = &in[MIO0_HEADER_LENGTH];
+   const unsigned char *comp;
+   const unsigned char *uncomp;
    unsigned int bytes_written = 0;
-   int bit_idx = 0;
-   int comp_idx = 0;
-   int uncomp_idx = 0;
+   unsigned int bits = 0;
+   int bits_left = 0;
    int valid;
 
    // extract header
@@ -161,138 +192,234 @@ int mio0_decode(const unsigned char *in, unsigned char *out, unsigned int *end)
    if (!valid) {
       return -2;
    }
+   comp = &in[head.comp_offset];
+   uncomp = &in[head.uncomp_offset];
 
    // decode data
    while (bytes_written < head.dest_size) {
-      if (GET_BIT(&in[MIO0_HEADER_LENGTH], bit_idx)) {
-         // 1 - pull uncompressed data
-         out[bytes_written] = in[head.uncomp_offset + uncomp_idx];
-         bytes_written++;
-         uncomp_idx++;
+      int run;
+      if (bits_left == 0) {
+         // the layout bits are padded to a 4-byte boundary, so whole words can be read
+         bits = read_u32_be(layout);
+         layout += 4;
+         bits_left = 32;
+      }
+      run = leading_ones(bits);
+      if (run > 0) {
+         // 1s - pull a run of uncompressed data
+         run = MIN(run, bits_left);
+         run = MIN((unsigned int)run, head.dest_size - bytes_written);
+         memcpy(&out[bytes_written], uncomp, run);
+         uncomp += run;
+         bytes_written += run;
       } else {
          // 0 - read compressed data
-         int idx;
-         int length;
-         int i;
-         const unsigned char *vals = &in[head.comp_offset + comp_idx];
-         comp_idx += 2;
-         length = ((vals[0] & 0xF0) >> 4) + 3;
-         idx = ((vals[0] & 0x0F) << 8) + vals[1] + 1;
-         for (i = 0; i < length; i++) {
-            out[bytes_written] = out[bytes_written - idx];
-            bytes_written++;
+         unsigned int length = (comp[0] >> 4) + 3;
+         unsigned int idx = ((comp[0] & 0x0F) << 8) + comp[1] + 1;
+         comp += 2;
+         if (idx >= 8 && bytes_written + 24 <= head.dest_size) {
+            // at least 8 bytes back, so 8-byte chunks only read bytes already written;
+            // the last chunk may spill past length, which later output overwrites
+            unsigned char *dst = &out[bytes_written];
+            memcpy(dst, dst - idx, 8);
+            memcpy(dst + 8, dst + 8 - idx, 8);
+            if (length > 16) {
+               memcpy(dst + 16, dst + 16 - idx, 8);
+            }
+         } else {
+            copy_backref(&out[bytes_written], idx, length);
          }
+         bytes_written += length;
+         run = 1;
       }
-      bit_idx++;
+      bits = run < 32 ? bits << run : 0;
+      bits_left -= run;
    }
 
    if (end) {
-      *end = head.uncomp_offset + uncomp_idx;
+      *end = uncomp - in;
    }
 
    return bytes_written;
 }
 
-int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out)
+// temporary buffers for the three MIO0 streams, sized for the worst case
+typedef struct
 {
    unsigned char *bit_buf;
    unsigned char *comp_buf;
    unsigned char *uncomp_buf;
+   int bit_idx;
+   int comp_idx;
+   int uncomp_idx;
+} mio0_streams;
+
+static void streams_init(mio0_streams *st, unsigned int length)
+{
+   st->bit_buf = calloc((length + 7) / 8, 1); // 1-bit/byte
+   st->comp_buf = malloc(length); // 16-bits/2bytes
+   st->uncomp_buf = malloc(length); // all uncompressed
+   st->bit_idx = 0;
+   st->comp_idx = 0;
+   st->uncomp_idx = 0;
+}
+
+static inline void streams_put_literal(mio0_streams *st, unsigned char val)
+{
+   st->uncomp_buf[st->uncomp_idx++] = val;
+   PUT_BIT(st->bit_buf, st->bit_idx++, 1);
+}
+
+static inline void streams_put_match(mio0_streams *st, int length, int offset)
+{
+   st->comp_buf[st->comp_idx] = (((length - 3) & 0x0F) << 4) |
+                                (((offset - 1) >> 8) & 0x0F);
+   st->comp_buf[st->comp_idx + 1] = (offset - 1) & 0xFF;
+   st->comp_idx += 2;
+   PUT_BIT(st->bit_buf, st->bit_idx++, 0);
+}
+
+// write the header and streams to out and free the streams
+// returns size of compressed data in 'out' including MIO0 header
+static int streams_finish(mio0_streams *st, unsigned int length, unsigned char *out)
+{
    unsigned int bit_length;
    unsigned int comp_offset;
    unsigned int uncomp_offset;
-   unsigned int bytes_proc = 0;
-   int bytes_written;
-   int bit_idx = 0;
-   int comp_idx = 0;
-   int uncomp_idx = 0;
-   lookback *lookbacks;
 
-   // initialize lookback buffer
-   lookbacks = lookback_init();
+   // compute final sizes and offsets
+   // +7 so int division accounts for all bits
+   bit_length = ((st->bit_idx + 7) / 8);
+   // compressed data after control bits and aligned to 4-byte boundary
+   comp_offset = ALIGN(MIO0_HEADER_LENGTH + bit_length, 4);
+   uncomp_offset = comp_offset + st->comp_idx;
 
-   // allocate some temporary buffers worst case size
-   bit_buf = malloc((length + 7) / 8); // 1-bit/byte
-   comp_buf = malloc(length); // 16-bits/2bytes
-   uncomp_buf = malloc(length); // all uncompressed
-   memset(bit_buf, 0, (length + 7) / 8);
+   // output header
+   memcpy(out, "MIO0", 4);
+   write_u32_be(&out[4], length);
+   write_u32_be(&out[8], comp_offset);
+   write_u32_be(&out[12], uncomp_offset);
+   // output data, zeroing the padding after the control bits
+   memset(&out[MIO0_HEADER_LENGTH], 0, comp_offset - MIO0_HEADER_LENGTH);
+   memcpy(&out[MIO0_HEADER_LENGTH], st->bit_buf, bit_length);
+   memcpy(&out[comp_offset], st->comp_buf, st->comp_idx);
+   memcpy(&out[uncomp_offset], st->uncomp_buf, st->uncomp_idx);
+
+   // free allocated buffers
+   free(st->bit_buf);
+   free(st->comp_buf);
+   free(st->uncomp_buf);
+
+   return uncomp_offset + st->uncomp_idx;
+}
+
+int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out)
+{
+   unsigned int bytes_proc = 0;
+   mio0_streams st;
+   match_finder *mf;
+
+   // initialize match finder
+   mf = match_finder_init(length);
+   streams_init(&st, length);
 
    // encode data
    // special case for first byte
-   lookback_push(lookbacks, in[0], 0);
-   uncomp_buf[uncomp_idx] = in[0];
-   uncomp_idx += 1;
+   match_finder_push(mf, in, length, 0);
+   streams_put_literal(&st, in[0]);
    bytes_proc += 1;
-   PUT_BIT(bit_buf, bit_idx++, 1);
    while (bytes_proc < length) {
       int offset;
-      int max_length = MIN(length - bytes_proc, 18);
-      int longest_match = find_longest(in, bytes_proc, max_length, &offset, lookbacks);
+      int max_length = MIN(length - bytes_proc, MAX_MATCH);
+      int longest_match = find_longest(in, bytes_proc, max_length, &offset, mf, 1);
       // push current byte before checking next longer match
-      lookback_push(lookbacks, in[bytes_proc], bytes_proc);
+      match_finder_push(mf, in, length, bytes_proc);
       if (longest_match > 2) {
          int lookahead_offset;
          // lookahead to next byte to see if longer match
-         int lookahead_length = MIN(length - bytes_proc - 1, 18);
-         int lookahead_match = find_longest(in, bytes_proc + 1, lookahead_length, &lookahead_offset, lookbacks);
+         int lookahead_length = MIN(length - bytes_proc - 1, MAX_MATCH);
+         int lookahead_match = find_longest(in, bytes_proc + 1, lookahead_length, &lookahead_offset, mf, 1);
          // better match found, use uncompressed + lookahead compressed
          if ((longest_match + 1) < lookahead_match) {
             // uncompressed byte
-            uncomp_buf[uncomp_idx] = in[bytes_proc];
-            uncomp_idx++;
-            PUT_BIT(bit_buf, bit_idx, 1);
+            streams_put_literal(&st, in[bytes_proc]);
             bytes_proc++;
             longest_match = lookahead_match;
             offset = lookahead_offset;
-            bit_idx++;
-            lookback_push(lookbacks, in[bytes_proc], bytes_proc);
+            match_finder_push(mf, in, length, bytes_proc);
          }
          // first byte already pushed above
          for (int i = 1; i < longest_match; i++) {
-            lookback_push(lookbacks, in[bytes_proc + i], bytes_proc + i);
+            match_finder_push(mf, in, length, bytes_proc + i);
          }
          // compressed block
-         comp_buf[comp_idx] = (((longest_match - 3) & 0x0F) << 4) |
-                              (((offset - 1) >> 8) & 0x0F);
-         comp_buf[comp_idx + 1] = (offset - 1) & 0xFF;
-         comp_idx += 2;
-         PUT_BIT(bit_buf, bit_idx, 0);
+         streams_put_match(&st, longest_match, offset);
          bytes_proc += longest_match;
       } else {
          // uncompressed byte
-         uncomp_buf[uncomp_idx] = in[bytes_proc];
-         uncomp_idx++;
-         PUT_BIT(bit_buf, bit_idx, 1);
+         streams_put_literal(&st, in[bytes_proc]);
          bytes_proc++;
       }
-      bit_idx++;
    }
 
-   // compute final sizes and offsets
-   // +7 so int division accounts for all bits
-   bit_length = ((bit_idx + 7) / 8);
-   // compressed data after control bits and aligned to 4-byte boundary
-   comp_offset = ALIGN(MIO0_HEADER_LENGTH + bit_length, 4);
-   uncomp_offset = comp_offset + comp_idx;
-   bytes_written = uncomp_offset + uncomp_idx;
+   match_finder_free(mf);
+   return streams_finish(&st, length, out);
+}
 
-   // output header
-   memcpy(out, "MIO0", 4);
-   write_u32_be(&out[4], length);
-   write_u32_be(&out[8], comp_offset);
-   write_u32_be(&out[12], uncomp_offset);
-   // output data
-   memcpy(&out[MIO0_HEADER_LENGTH], bit_buf, bit_length);
-   memcpy(&out[comp_offset], comp_buf, comp_idx);
-   memcpy(&out[uncomp_offset], uncomp_buf, uncomp_idx);
+// cost in bits of an uncompressed byte and a back-reference
+#define LITERAL_COST 9
+#define MATCH_COST 17
 
-   // free allocated buffers
-   free(bit_buf);
-   free(comp_buf);
-   free(uncomp_buf);
-   lookback_free(lookbacks);
+int mio0_encode_optimal(const unsigned char *in, unsigned int length, unsigned char *out)
+{
+   unsigned int *cost = malloc((length + 1) * sizeof(*cost));
+   unsigned char *match_length = malloc(length + 1);
+   unsigned short *match_offset = malloc((length + 1) * sizeof(*match_offset));
+   unsigned char *choice = malloc(length + 1);
+   unsigned int i;
+   mio0_streams st;
+   match_finder *mf;
 
-   return bytes_written;
+   // longest match at every position; any shorter length at the same offset matches too
+   mf = match_finder_init(length);
+   for (i = 0; i < length; i++) {
+      int offset;
+      match_length[i] = find_longest(in, i, MIN(length - i, MAX_MATCH), &offset, mf, 0);
+      match_offset[i] = offset;
+      match_finder_push(mf, in, length, i);
+   }
+   match_finder_free(mf);
+
+   // cheapest encoding of every suffix of the input
+   cost[length] = 0;
+   for (i = length; i-- > 0; ) {
+      unsigned int l;
+      cost[i] = LITERAL_COST + cost[i + 1];
+      choice[i] = 1;
+      for (l = 3; l <= match_length[i]; l++) {
+         if (MATCH_COST + cost[i + l] < cost[i]) {
+            cost[i] = MATCH_COST + cost[i + l];
+            choice[i] = l;
+         }
+      }
+   }
+
+   streams_init(&st, length);
+   for (i = 0; i < length; ) {
+      if (choice[i] == 1) {
+         streams_put_literal(&st, in[i]);
+         i++;
+      } else {
+         streams_put_match(&st, choice[i], match_offset[i]);
+         i += choice[i];
+      }
+   }
+
+   free(cost);
+   free(match_length);
+   free(match_offset);
+   free(choice);
+   return streams_finish(&st, length, out);
 }
 
 static FILE *mio0_open_out_file(const char *out_file) {
@@ -382,7 +509,7 @@ free_all:
    return ret_val;
 }
 
-int mio0_encode_file(const char *in_file, const char *out_file)
+int mio0_encode_file(const char *in_file, const char *out_file, int optimal)
 {
    FILE *in;
    FILE *out;
@@ -416,7 +543,11 @@ int mio0_encode_file(const char *in_file, const char *out_file)
    out_buf = malloc(MIO0_HEADER_LENGTH + ((file_size+7)/8) + file_size);
 
    // compress data in MIO0 format
-   bytes_encoded = mio0_encode(in_buf, file_size, out_buf);
+   if (optimal) {
+      bytes_encoded = mio0_encode_optimal(in_buf, file_size, out_buf);
+   } else {
+      bytes_encoded = mio0_encode(in_buf, file_size, out_buf);
+   }
 
    // open output file
    out = mio0_open_out_file(out_file);
@@ -449,12 +580,21 @@ free_all:
 
 // mio0 standalone executable
 #ifdef MIO0_STANDALONE
+#include <pthread.h>
+#include <time.h>
+
 typedef struct
 {
    char *in_filename;
    char *out_filename;
    unsigned int offset;
    int compress;
+   int optimal;
+   int benchmark;
+   unsigned int fuzz_count;
+   int jobs;
+   char **files;
+   int file_count;
 } arg_config;
 
 static arg_config default_config =
@@ -462,12 +602,256 @@ static arg_config default_config =
    NULL,
    NULL,
    0,
-   1
+   1,
+   0,
+   0,
+   0,
+   0,
+   NULL,
+   0
 };
 
+// original bit-at-a-time decoder, used as the reference for -b and -f
+static int mio0_decode_reference(const unsigned char *in, unsigned char *out, unsigned int *end)
+{
+   mio0_header_t head;
+   unsigned int bytes_written = 0;
+   int bit_idx = 0;
+   int comp_idx = 0;
+   int uncomp_idx = 0;
+   int valid;
+
+   valid = mio0_decode_header(in, &head);
+   if (!valid) {
+      return -2;
+   }
+
+   while (bytes_written < head.dest_size) {
+      if (GET_BIT(&in[MIO0_HEADER_LENGTH], bit_idx)) {
+         out[bytes_written] = in[head.uncomp_offset + uncomp_idx];
+         bytes_written++;
+         uncomp_idx++;
+      } else {
+         int idx;
+         int length;
+         int i;
+         const unsigned char *vals = &in[head.comp_offset + comp_idx];
+         comp_idx += 2;
+         length = ((vals[0] & 0xF0) >> 4) + 3;
+         idx = ((vals[0] & 0x0F) << 8) + vals[1] + 1;
+         for (i = 0; i < length; i++) {
+            out[bytes_written] = out[bytes_written - idx];
+            bytes_written++;
+         }
+      }
+      bit_idx++;
+   }
+
+   if (end) {
+      *end = head.uncomp_offset + uncomp_idx;
+   }
+
+   return bytes_written;
+}
+
+// decode with both decoders and compare the results
+// returns 0 if they match
+static int mio0_check_decoders(const unsigned char *in, unsigned int dest_size)
+{
+   unsigned char *out_ref = malloc(dest_size + 1);
+   unsigned char *out_fast = malloc(dest_size + 1);
+   unsigned int end_ref = 0;
+   unsigned int end_fast = 0;
+   int len_ref = mio0_decode_reference(in, out_ref, &end_ref);
+   int len_fast = mio0_decode(in, out_fast, &end_fast);
+   int ret_val = 0;
+
+   if (len_ref != len_fast || end_ref != end_fast ||
+       (len_ref > 0 && memcmp(out_ref, out_fast, len_ref) != 0)) {
+      ret_val = 1;
+   }
+   free(out_ref);
+   free(out_fast);
+   return ret_val;
+}
+
+// build a random but valid MIO0 block decoding to dest_size bytes, with
+// back-references of every length and distance, including overlapping ones
+static int mio0_random_block(unsigned char *out, unsigned int dest_size)
+{
+   unsigned char *bit_buf = calloc((dest_size + 7) / 8 + 4, 1);
+   unsigned char *comp_buf = malloc(dest_size + 2);
+   unsigned char *uncomp_buf = malloc(dest_size + 1);
+   unsigned int written = 0;
+   int bit_idx = 0;
+   int comp_idx = 0;
+   int uncomp_idx = 0;
+   unsigned int comp_offset;
+   unsigned int uncomp_offset;
+
+   while (written < dest_size) {
+      unsigned int remaining = dest_size - written;
+      // long literal runs cross layout words, short ones interleave with references
+      if (written == 0 || remaining < 3 || rand() % 3 == 0) {
+         int run = rand() % 40 + 1;
+         while (run-- > 0 && written < dest_size) {
+            uncomp_buf[uncomp_idx++] = rand() & 0xFF;
+            PUT_BIT(bit_buf, bit_idx++, 1);
+            written++;
+         }
+      } else {
+         unsigned int max_dist = MIN(written, 4096);
+         unsigned int dist = rand() % 4 == 0 ? rand() % MIN(max_dist, 20) + 1 : rand() % max_dist + 1;
+         unsigned int length = rand() % (MIN(remaining, 18) - 2) + 3;
+         comp_buf[comp_idx] = ((length - 3) << 4) | ((dist - 1) >> 8);
+         comp_buf[comp_idx + 1] = (dist - 1) & 0xFF;
+         comp_idx += 2;
+         PUT_BIT(bit_buf, bit_idx++, 0);
+         written += length;
+      }
+   }
+
+   comp_offset = ALIGN(MIO0_HEADER_LENGTH + (bit_idx + 7) / 8, 4);
+   uncomp_offset = comp_offset + comp_idx;
+   memcpy(out, "MIO0", 4);
+   write_u32_be(&out[4], dest_size);
+   write_u32_be(&out[8], comp_offset);
+   write_u32_be(&out[12], uncomp_offset);
+   memset(&out[MIO0_HEADER_LENGTH], 0, comp_offset - MIO0_HEADER_LENGTH);
+   memcpy(&out[MIO0_HEADER_LENGTH], bit_buf, (bit_idx + 7) / 8);
+   memcpy(&out[comp_offset], comp_buf, comp_idx);
+   memcpy(&out[uncomp_offset], uncomp_buf, uncomp_idx);
+
+   free(bit_buf);
+   free(comp_buf);
+   free(uncomp_buf);
+   return uncomp_offset + uncomp_idx;
+}
+
+// compare the decoders on random blocks, and check that encoding round trips
+static int mio0_fuzz(unsigned int count)
+{
+   unsigned int max_size = 0x10000;
+   unsigned char *block = malloc(MIO0_HEADER_LENGTH + max_size / 8 + 4 + 3 * max_size);
+   unsigned char *raw = malloc(max_size);
+   unsigned char *decoded = malloc(max_size);
+   unsigned int i, j;
+   int failures = 0;
+
+   srand(1);
+   for (i = 0; i < count; i++) {
+      unsigned int size = rand() % max_size + 1;
+      int encoded;
+
+      mio0_random_block(block, size);
+      if (mio0_check_decoders(block, size)) {
+         ERROR("Decoder mismatch on random block %u (%u bytes)\n", i, size);
+         failures++;
+      }
+
+      // mostly repetitive data, so the encoder finds matches of all kinds
+      for (j = 0; j < size; j++) {
+         raw[j] = (rand() % 8 == 0 || j < 16) ? rand() & 0xFF : raw[j - 1 - rand() % 16];
+      }
+      for (j = 0; j < 2; j++) {
+         encoded = j ? mio0_encode_optimal(raw, size, block) : mio0_encode(raw, size, block);
+         if (mio0_check_decoders(block, size) || mio0_decode(block, decoded, NULL) != (int)size ||
+             memcmp(raw, decoded, size) != 0) {
+            ERROR("Round trip failed on random input %u (%u bytes, %d encoded%s)\n", i, size, encoded,
+                  j ? ", optimal" : "");
+            failures++;
+         }
+      }
+   }
+   printf("%u random blocks: %d failures\n", count, failures);
+
+   free(block);
+   free(raw);
+   free(decoded);
+   return failures ? 6 : 0;
+}
+
+static double mio0_time_decoder(int (*decoder)(const unsigned char *, unsigned char *, unsigned int *),
+                                const unsigned char *in, unsigned char *out, int iterations)
+{
+   clock_t start = clock();
+   int i;
+   for (i = 0; i < iterations; i++) {
+      decoder(in, out, NULL);
+   }
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// decode each file with both decoders, verify they agree and report throughput
+static int mio0_benchmark(char **files, int file_count)
+{
+   double total_ref = 0.0;
+   double total_fast = 0.0;
+   unsigned long long total_bytes = 0;
+   int failures = 0;
+   int i;
+
+   for (i = 0; i < file_count; i++) {
+      mio0_header_t head;
+      FILE *in = fopen(files[i], "rb");
+      unsigned char *in_buf;
+      unsigned char *out_buf;
+      long file_size;
+      int iterations;
+      double time_ref, time_fast;
+
+      if (in == NULL) {
+         ERROR("Error opening input file \"%s\"\n", files[i]);
+         failures++;
+         continue;
+      }
+      fseek(in, 0, SEEK_END);
+      file_size = ftell(in);
+      fseek(in, 0, SEEK_SET);
+      in_buf = malloc(file_size + 4);
+      memset(in_buf, 0, file_size + 4);
+      if (fread(in_buf, 1, file_size, in) != (size_t)file_size || !mio0_decode_header(in_buf, &head)) {
+         ERROR("Skipping \"%s\": not MIO0 data\n", files[i]);
+         fclose(in);
+         free(in_buf);
+         continue;
+      }
+      fclose(in);
+
+      if (mio0_check_decoders(in_buf, head.dest_size)) {
+         ERROR("Decoder mismatch on \"%s\"\n", files[i]);
+         failures++;
+      }
+
+      // decode roughly 64 MB per decoder
+      iterations = MAX(1, (int)(64 * MB / MAX(head.dest_size, 1)));
+      out_buf = malloc(head.dest_size + 1);
+      time_ref = mio0_time_decoder(mio0_decode_reference, in_buf, out_buf, iterations);
+      time_fast = mio0_time_decoder(mio0_decode, in_buf, out_buf, iterations);
+      printf("%-60s %8u bytes %8.1f MB/s -> %8.1f MB/s (%.2fx)\n", files[i], head.dest_size,
+             (double)head.dest_size * iterations / MB / time_ref,
+             (double)head.dest_size * iterations / MB / time_fast, time_ref / time_fast);
+
+      total_ref += time_ref / iterations;
+      total_fast += time_fast / iterations;
+      total_bytes += head.dest_size;
+      free(out_buf);
+      free(in_buf);
+   }
+
+   if (total_fast > 0.0) {
+      printf("Total: %llu bytes, %.3f ms -> %.3f ms per pass (%.2fx), %d failures\n", total_bytes,
+             total_ref * 1000.0, total_fast * 1000.0, total_ref / total_fast, failures);
+   }
+   return failures ? 6 : 0;
+}
+
 static void print_usage(void)
 {
-   ERROR("Usage: mio0 [-c / -d] [-o OFFSET] FILE [OUTPUT]\n"
+   ERROR("Usage: mio0 [-c / -d] [-O] [-o OFFSET] FILE [OUTPUT]\n"
+         "       mio0 [-c / -d] [-O] -j JOBS FILE OUTPUT [FILE OUTPUT]...\n"
+         "       mio0 -b FILE...\n"
+         "       mio0 -f COUNT\n"
          "\n"
          "mio0 v" MIO0_VERSION ": MIO0 compression and decompression tool\n"
          "\n"
@@ -475,6 +859,10 @@ static void print_usage(void)
          " -c           compress raw data into MIO0 (default: compress)\n"
          " -d           decompress MIO0 into raw data\n"
          " -o OFFSET    starting offset in FILE (default: 0)\n"
+         " -O           compress with optimal parsing: smaller, but differs from the original ROM\n"
+         " -j JOBS      process pairs of FILE and OUTPUT, JOBS at a time\n"
+         " -b           benchmark decoding MIO0 FILEs against the reference decoder\n"
+         " -f COUNT     check the decoder against the reference decoder on COUNT random blocks\n"
          "\n"
          "File arguments:\n"
          " FILE        input file\n"
@@ -491,6 +879,7 @@ static void parse_arguments(int argc, char *argv[], arg_config *config)
       print_usage();
       exit(1);
    }
+   config->files = malloc(argc * sizeof(*config->files));
    for (i = 1; i < argc; i++) {
       if (argv[i][0] == '-' && argv[i][1] != '\0') {
          switch (argv[i][1]) {
@@ -506,6 +895,24 @@ static void parse_arguments(int argc, char *argv[], arg_config *config)
                }
                config->offset = strtoul(argv[i], NULL, 0);
                break;
+            case 'O':
+               config->optimal = 1;
+               break;
+            case 'j':
+               if (++i >= argc) {
+                  print_usage();
+               }
+               config->jobs = strtoul(argv[i], NULL, 0);
+               break;
+            case 'b':
+               config->benchmark = 1;
+               break;
+            case 'f':
+               if (++i >= argc) {
+                  print_usage();
+               }
+               config->fuzz_count = strtoul(argv[i], NULL, 0);
+               break;
             default:
                print_usage();
                break;
@@ -518,58 +925,136 @@ static void parse_arguments(int argc, char *argv[], arg_config *config)
             case 1:
                config->out_filename = argv[i];
                break;
-            default: // too many
-               print_usage();
+            default: // too many, unless benchmarking or processing several files
+               if (!config->benchmark && config->jobs == 0) {
+                  print_usage();
+               }
                break;
          }
-         file_count++;
+         config->files[file_count++] = argv[i];
       }
    }
-   if (file_count < 1) {
+   config->file_count = file_count;
+   if (file_count < 1 && config->fuzz_count == 0) {
+      print_usage();
+   }
+   if (config->jobs > 0 && file_count % 2 != 0) {
       print_usage();
    }
 }
 
-int main(int argc, char *argv[])
+// compress or decompress one file, reporting any error
+static int process_file(const arg_config *config, const char *in_filename, const char *out_filename)
 {
-   char out_filename[FILENAME_MAX];
-   arg_config config;
    int ret_val;
 
-   // get configuration from arguments
-   config = default_config;
-   parse_arguments(argc, argv, &config);
-   if (config.out_filename == NULL) {
-      config.out_filename = out_filename;
-      sprintf(config.out_filename, "%s.out", config.in_filename);
-   }
-
    // operation
-   if (config.compress) {
-      ret_val = mio0_encode_file(config.in_filename, config.out_filename);
+   if (config->compress) {
+      ret_val = mio0_encode_file(in_filename, out_filename, config->optimal);
    } else {
-      ret_val = mio0_decode_file(config.in_filename, config.offset, config.out_filename);
+      ret_val = mio0_decode_file(in_filename, config->offset, out_filename);
    }
 
    switch (ret_val) {
       case 1:
-         ERROR("Error opening input file \"%s\"\n", config.in_filename);
+         ERROR("Error opening input file \"%s\"\n", in_filename);
          break;
       case 2:
-         ERROR("Error reading from input file \"%s\"\n", config.in_filename);
+         ERROR("Error reading from input file \"%s\"\n", in_filename);
          break;
       case 3:
-         ERROR("Error decoding MIO0 data. Wrong offset (0x%X)?\n", config.offset);
+         ERROR("Error decoding MIO0 data. Wrong offset (0x%X)?\n", config->offset);
          break;
       case 4:
-         ERROR("Error opening output file \"%s\"\n", config.out_filename);
+         ERROR("Error opening output file \"%s\"\n", out_filename);
          break;
       case 5:
-         ERROR("Error writing bytes to output file \"%s\"\n", config.out_filename);
+         ERROR("Error writing bytes to output file \"%s\"\n", out_filename);
          break;
    }
 
    return ret_val;
 }
-#endif // MIO0_STANDALONE
 
+typedef struct
+{
+   const arg_config *config;
+   pthread_mutex_t lock;
+   int next_pair;
+   int ret_val;
+} job_queue;
+
+static void *job_worker(void *arg)
+{
+   job_queue *queue = arg;
+   for (;;) {
+      int pair;
+      int ret_val;
+
+      pthread_mutex_lock(&queue->lock);
+      pair = queue->next_pair++;
+      pthread_mutex_unlock(&queue->lock);
+      if (pair * 2 >= queue->config->file_count) {
+         break;
+      }
+
+      ret_val = process_file(queue->config, queue->config->files[pair * 2], queue->config->files[pair * 2 + 1]);
+      if (ret_val != 0) {
+         pthread_mutex_lock(&queue->lock);
+         if (queue->ret_val == 0) {
+            queue->ret_val = ret_val;
+         }
+         pthread_mutex_unlock(&queue->lock);
+      }
+   }
+   return NULL;
+}
+
+// process every FILE OUTPUT pair, on up to config->jobs threads
+static int process_files(const arg_config *config)
+{
+   int thread_count = MIN(config->jobs, config->file_count / 2);
+   pthread_t *threads = malloc(thread_count * sizeof(*threads));
+   job_queue queue;
+   int i;
+
+   queue.config = config;
+   pthread_mutex_init(&queue.lock, NULL);
+   queue.next_pair = 0;
+   queue.ret_val = 0;
+   for (i = 0; i < thread_count; i++) {
+      pthread_create(&threads[i], NULL, job_worker, &queue);
+   }
+   for (i = 0; i < thread_count; i++) {
+      pthread_join(threads[i], NULL);
+   }
+   pthread_mutex_destroy(&queue.lock);
+   free(threads);
+   return queue.ret_val;
+}
+
+int main(int argc, char *argv[])
+{
+   char out_filename[FILENAME_MAX];
+   arg_config config;
+
+   // get configuration from arguments
+   config = default_config;
+   parse_arguments(argc, argv, &config);
+   if (config.fuzz_count > 0) {
+      return mio0_fuzz(config.fuzz_count);
+   }
+   if (config.benchmark) {
+      return mio0_benchmark(config.files, config.file_count);
+   }
+   if (config.jobs > 0) {
+      return process_files(&config);
+   }
+   if (config.out_filename == NULL) {
+      config.out_filename = out_filename;
+      sprintf(config.out_filename, "%s.out", config.in_filename);
+   }
+
+   return process_file(&config, config.in_filename, config.out_filename);
+}
+#endif // MIO0_STANDALONE